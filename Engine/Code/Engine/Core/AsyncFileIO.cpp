@@ -0,0 +1,433 @@
+#include "Engine/Core/AsyncFileIO.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <fstream>
+
+#if defined(ASYNC_FILE_IO_URING_AVAILABLE)
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+AsyncFileIO* g_theAsyncFileIO = nullptr;
+
+bool ReadFileBlocking(std::string const& filePath, std::vector<uint8_t>& out_data)
+{
+	std::ifstream inFile(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!inFile.is_open()) return false;
+
+	std::streamoff fileSize = inFile.tellg();
+	if (fileSize < 0) return false;
+
+	out_data.resize(static_cast<size_t>(fileSize));
+	inFile.seekg(0, std::ios::beg);
+	inFile.read(reinterpret_cast<char*>(out_data.data()), fileSize);
+
+	return !inFile.bad() && (inFile.gcount() == fileSize);
+}
+
+#if defined(ASYNC_FILE_IO_URING_AVAILABLE)
+// No liburing, the rings are mapped and driven through the raw syscalls
+constexpr uint64_t IO_URING_WAKE_UP_USER_DATA = ~0ull; // Completions of the eventfd poll, every other user data is a read slot
+constexpr size_t IO_URING_MAX_READ_SIZE = 1 << 30; // Bigger files take several reads
+
+struct AsyncFileIOUring {
+	struct Read {
+		FileReadRequest* m_request = nullptr;
+		int m_fileDescriptor = -1;
+		size_t m_bytesRead = 0;
+		iovec m_buffer = {};
+	};
+
+	int m_ringFileDescriptor = -1;
+	int m_wakeUpFileDescriptor = -1; // eventfd polled through the ring, so new requests can wake up a thread waiting on completions
+
+	void* m_submissionRing = nullptr;
+	size_t m_submissionRingSize = 0;
+	void* m_completionRing = nullptr;
+	size_t m_completionRingSize = 0;
+	io_uring_sqe* m_submissionEntries = nullptr;
+	size_t m_submissionEntriesSize = 0;
+
+	unsigned* m_submissionHead = nullptr;
+	unsigned* m_submissionTail = nullptr;
+	unsigned* m_submissionMask = nullptr;
+	unsigned* m_submissionArray = nullptr;
+	unsigned* m_completionHead = nullptr;
+	unsigned* m_completionTail = nullptr;
+	unsigned* m_completionMask = nullptr;
+	io_uring_cqe* m_completionEntries = nullptr;
+	unsigned m_amountToSubmit = 0;
+
+	std::vector<Read> m_reads; // Read slots, one per read in flight
+	std::vector<int> m_freeReads;
+	std::vector<FileReadRequest*> m_startingRequests; // Taken from the pending queue, kept around so it doesn't reallocate
+};
+
+static void QueueSubmission(AsyncFileIOUring& ioUring, io_uring_sqe const& submission)
+{
+	// Only the io_uring thread submits, and there's never more in flight than the ring holds
+	unsigned submissionTail = *ioUring.m_submissionTail;
+	unsigned entryIndex = submissionTail & *ioUring.m_submissionMask;
+	ioUring.m_submissionEntries[entryIndex] = submission;
+	ioUring.m_submissionArray[entryIndex] = entryIndex;
+	__atomic_store_n(ioUring.m_submissionTail, submissionTail + 1, __ATOMIC_RELEASE);
+	ioUring.m_amountToSubmit++;
+}
+
+static void QueueWakeUpPoll(AsyncFileIOUring& ioUring)
+{
+	io_uring_sqe submission;
+	memset(&submission, 0, sizeof(submission));
+	submission.opcode = IORING_OP_POLL_ADD;
+	submission.fd = ioUring.m_wakeUpFileDescriptor;
+	submission.poll_events = POLLIN;
+	submission.user_data = IO_URING_WAKE_UP_USER_DATA;
+	QueueSubmission(ioUring, submission);
+}
+
+static void QueueRead(AsyncFileIOUring& ioUring, int readIndex)
+{
+	AsyncFileIOUring::Read& fileRead = ioUring.m_reads[readIndex];
+	size_t remainingBytes = fileRead.m_request->m_data.size() - fileRead.m_bytesRead;
+	fileRead.m_buffer.iov_base = fileRead.m_request->m_data.data() + fileRead.m_bytesRead;
+	fileRead.m_buffer.iov_len = (remainingBytes < IO_URING_MAX_READ_SIZE) ? remainingBytes : IO_URING_MAX_READ_SIZE;
+
+	// READV instead of READ, so kernels from 5.1 on work
+	io_uring_sqe submission;
+	memset(&submission, 0, sizeof(submission));
+	submission.opcode = IORING_OP_READV;
+	submission.fd = fileRead.m_fileDescriptor;
+	submission.addr = reinterpret_cast<uint64_t>(&fileRead.m_buffer);
+	submission.len = 1;
+	submission.off = fileRead.m_bytesRead;
+	submission.user_data = static_cast<uint64_t>(readIndex);
+	QueueSubmission(ioUring, submission);
+}
+
+static void ReleaseIoUring(AsyncFileIOUring* ioUring)
+{
+	if (ioUring->m_submissionEntries) munmap(ioUring->m_submissionEntries, ioUring->m_submissionEntriesSize);
+	if (ioUring->m_completionRing && (ioUring->m_completionRing != ioUring->m_submissionRing)) munmap(ioUring->m_completionRing, ioUring->m_completionRingSize);
+	if (ioUring->m_submissionRing) munmap(ioUring->m_submissionRing, ioUring->m_submissionRingSize);
+	if (ioUring->m_wakeUpFileDescriptor >= 0) close(ioUring->m_wakeUpFileDescriptor);
+	if (ioUring->m_ringFileDescriptor >= 0) close(ioUring->m_ringFileDescriptor);
+	delete ioUring;
+}
+#endif
+
+AsyncFileIO::AsyncFileIO(AsyncFileIOConfig const& config) :
+	m_config(config)
+{
+	if (m_config.m_amountOfThreads < 1) m_config.m_amountOfThreads = 1;
+	if (m_config.m_queueDepth < 1) m_config.m_queueDepth = 1;
+}
+
+AsyncFileIO::~AsyncFileIO()
+{
+}
+
+void AsyncFileIO::Startup()
+{
+	m_isQuitting = false;
+
+	// Looked up here rather than in the constructor, the app may create g_theJobSystem after the AsyncFileIO
+	if (!m_config.m_jobSystem) {
+		m_config.m_jobSystem = g_theJobSystem;
+	}
+
+#if defined(ASYNC_FILE_IO_URING_AVAILABLE)
+	// Containers and hardened kernels often refuse io_uring_setup, the thread pool works everywhere
+	if (m_config.m_useIoUring && StartIoUring()) {
+		m_threads.push_back(new std::thread(&AsyncFileIO::IoUringThreadMain, this));
+		return;
+	}
+#endif
+
+	for (int threadIndex = 0; threadIndex < m_config.m_amountOfThreads; threadIndex++) {
+		m_threads.push_back(new std::thread(&AsyncFileIO::ReaderThreadMain, this));
+	}
+}
+
+void AsyncFileIO::Shutdown()
+{
+	m_pendingRequestsMutex.lock(); // lock
+	m_isQuitting = true;
+	m_pendingRequestsMutex.unlock(); // unlock
+	m_pendingRequestsCondition.notify_all();
+
+#if defined(ASYNC_FILE_IO_URING_AVAILABLE)
+	if (m_ioUring) {
+		uint64_t wakeUpValue = 1;
+		(void)write(m_ioUring->m_wakeUpFileDescriptor, &wakeUpValue, sizeof(wakeUpValue));
+	}
+#endif
+
+	for (int threadIndex = 0; threadIndex < m_threads.size(); threadIndex++) {
+		m_threads[threadIndex]->join();
+		delete m_threads[threadIndex];
+		m_threads[threadIndex] = nullptr;
+	}
+	m_threads.clear();
+
+#if defined(ASYNC_FILE_IO_URING_AVAILABLE)
+	StopIoUring();
+#endif
+}
+
+void AsyncFileIO::ReadFile(FileReadRequest& request, JobCounter* completionCounter)
+{
+	ReadFiles(&request, 1, completionCounter);
+}
+
+void AsyncFileIO::ReadFiles(FileReadRequest* requests, int amountOfRequests, JobCounter* completionCounter)
+{
+	if (amountOfRequests <= 0) return;
+	if (completionCounter) {
+		GUARANTEE_OR_DIE(m_config.m_jobSystem != nullptr, "ASYNC FILE IO NEEDS A JOBSYSTEM FOR COMPLETION COUNTERS, SET AsyncFileIOConfig::m_jobSystem OR CREATE g_theJobSystem BEFORE Startup");
+	}
+
+	for (int requestIndex = 0; requestIndex < amountOfRequests; requestIndex++) {
+		requests[requestIndex].m_status = FileReadStatus::PENDING;
+		requests[requestIndex].m_completionCounter = completionCounter;
+	}
+
+	// Counted before anything can complete, so the counter can't reach 0 halfway through the batch
+	if (completionCounter) {
+		m_config.m_jobSystem->AddPendingWork(*completionCounter, amountOfRequests);
+	}
+	m_amountOfReadsInFlight += amountOfRequests;
+
+	m_pendingRequestsMutex.lock(); // lock
+	for (int requestIndex = 0; requestIndex < amountOfRequests; requestIndex++) {
+		m_pendingRequests.push_back(&requests[requestIndex]);
+	}
+	m_pendingRequestsMutex.unlock(); // unlock
+
+#if defined(ASYNC_FILE_IO_URING_AVAILABLE)
+	if (m_ioUring) {
+		uint64_t wakeUpValue = 1;
+		(void)write(m_ioUring->m_wakeUpFileDescriptor, &wakeUpValue, sizeof(wakeUpValue));
+		return;
+	}
+#endif
+
+	if (amountOfRequests > 1) {
+		m_pendingRequestsCondition.notify_all();
+	}
+	else {
+		m_pendingRequestsCondition.notify_one();
+	}
+}
+
+void AsyncFileIO::CompleteRead(FileReadRequest& request, FileReadStatus status)
+{
+	// Whoever waits on the counter may destroy the request right after it's signaled, so the status goes first
+	JobCounter* completionCounter = request.m_completionCounter;
+	request.m_status.store(status, std::memory_order_release);
+	m_amountOfReadsInFlight--;
+
+	if (completionCounter) {
+		m_config.m_jobSystem->CompletePendingWork(*completionCounter);
+	}
+}
+
+void AsyncFileIO::ReaderThreadMain()
+{
+	while (true) {
+		FileReadRequest* request = nullptr;
+		{
+			std::unique_lock<std::mutex> pendingRequestsLock(m_pendingRequestsMutex);
+			m_pendingRequestsCondition.wait(pendingRequestsLock, [this]() {
+				return !m_pendingRequests.empty() || m_isQuitting;
+			});
+
+			// Quitting still finishes every queued read, nobody waiting on them should hang
+			if (m_pendingRequests.empty()) return;
+			request = m_pendingRequests.front();
+			m_pendingRequests.pop_front();
+		}
+
+		bool isReadSuccessful = ReadFileBlocking(request->m_filePath, request->m_data);
+		CompleteRead(*request, (isReadSuccessful) ? FileReadStatus::COMPLETED : FileReadStatus::FAILED);
+	}
+}
+
+#if defined(ASYNC_FILE_IO_URING_AVAILABLE)
+bool AsyncFileIO::StartIoUring()
+{
+	AsyncFileIOUring* ioUring = new AsyncFileIOUring();
+
+	io_uring_params ringParams;
+	memset(&ringParams, 0, sizeof(ringParams));
+	unsigned amountOfEntries = static_cast<unsigned>(m_config.m_queueDepth + 1); // The wake up poll takes an entry too
+	ioUring->m_ringFileDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, amountOfEntries, &ringParams));
+	if (ioUring->m_ringFileDescriptor < 0) {
+		ReleaseIoUring(ioUring);
+		return false;
+	}
+
+	ioUring->m_submissionRingSize = ringParams.sq_off.array + ringParams.sq_entries * sizeof(unsigned);
+	ioUring->m_completionRingSize = ringParams.cq_off.cqes + ringParams.cq_entries * sizeof(io_uring_cqe);
+	bool isSingleMapping = (ringParams.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (isSingleMapping) {
+		if (ioUring->m_completionRingSize > ioUring->m_submissionRingSize) ioUring->m_submissionRingSize = ioUring->m_completionRingSize;
+		ioUring->m_completionRingSize = ioUring->m_submissionRingSize;
+	}
+
+	void* submissionRing = mmap(nullptr, ioUring->m_submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ioUring->m_ringFileDescriptor, IORING_OFF_SQ_RING);
+	ioUring->m_submissionRing = (submissionRing == MAP_FAILED) ? nullptr : submissionRing;
+
+	void* completionRing = (isSingleMapping) ? submissionRing : mmap(nullptr, ioUring->m_completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ioUring->m_ringFileDescriptor, IORING_OFF_CQ_RING);
+	ioUring->m_completionRing = (completionRing == MAP_FAILED) ? nullptr : completionRing;
+
+	ioUring->m_submissionEntriesSize = ringParams.sq_entries * sizeof(io_uring_sqe);
+	void* submissionEntries = mmap(nullptr, ioUring->m_submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ioUring->m_ringFileDescriptor, IORING_OFF_SQES);
+	ioUring->m_submissionEntries = (submissionEntries == MAP_FAILED) ? nullptr : static_cast<io_uring_sqe*>(submissionEntries);
+
+	ioUring->m_wakeUpFileDescriptor = eventfd(0, EFD_CLOEXEC);
+
+	if (!ioUring->m_submissionRing || !ioUring->m_completionRing || !ioUring->m_submissionEntries || (ioUring->m_wakeUpFileDescriptor < 0)) {
+		ReleaseIoUring(ioUring);
+		return false;
+	}
+
+	unsigned char* submissionRingBytes = static_cast<unsigned char*>(ioUring->m_submissionRing);
+	ioUring->m_submissionHead = reinterpret_cast<unsigned*>(submissionRingBytes + ringParams.sq_off.head);
+	ioUring->m_submissionTail = reinterpret_cast<unsigned*>(submissionRingBytes + ringParams.sq_off.tail);
+	ioUring->m_submissionMask = reinterpret_cast<unsigned*>(submissionRingBytes + ringParams.sq_off.ring_mask);
+	ioUring->m_submissionArray = reinterpret_cast<unsigned*>(submissionRingBytes + ringParams.sq_off.array);
+
+	unsigned char* completionRingBytes = static_cast<unsigned char*>(ioUring->m_completionRing);
+	ioUring->m_completionHead = reinterpret_cast<unsigned*>(completionRingBytes + ringParams.cq_off.head);
+	ioUring->m_completionTail = reinterpret_cast<unsigned*>(completionRingBytes + ringParams.cq_off.tail);
+	ioUring->m_completionMask = reinterpret_cast<unsigned*>(completionRingBytes + ringParams.cq_off.ring_mask);
+	ioUring->m_completionEntries = reinterpret_cast<io_uring_cqe*>(completionRingBytes + ringParams.cq_off.cqes);
+
+	ioUring->m_reads.resize(m_config.m_queueDepth);
+	for (int readIndex = m_config.m_queueDepth - 1; readIndex >= 0; readIndex--) {
+		ioUring->m_freeReads.push_back(readIndex);
+	}
+
+	m_ioUring = ioUring;
+	return true;
+}
+
+void AsyncFileIO::StopIoUring()
+{
+	if (!m_ioUring) return;
+
+	ReleaseIoUring(m_ioUring);
+	m_ioUring = nullptr;
+}
+
+void AsyncFileIO::IoUringThreadMain()
+{
+	AsyncFileIOUring& ioUring = *m_ioUring;
+	QueueWakeUpPoll(ioUring);
+
+	while (true) {
+		// Only as many new reads as there are free slots, the rest stay pending until reads complete
+		ioUring.m_startingRequests.clear();
+		m_pendingRequestsMutex.lock(); // lock
+		bool isQuitting = m_isQuitting;
+		while (!m_pendingRequests.empty() && (ioUring.m_startingRequests.size() < ioUring.m_freeReads.size())) {
+			ioUring.m_startingRequests.push_back(m_pendingRequests.front());
+			m_pendingRequests.pop_front();
+		}
+		bool areRequestsPending = !m_pendingRequests.empty();
+		m_pendingRequestsMutex.unlock(); // unlock
+
+		bool areReadsInFlight = ioUring.m_freeReads.size() < ioUring.m_reads.size();
+		if (isQuitting && !areRequestsPending && !areReadsInFlight && ioUring.m_startingRequests.empty()) break;
+
+		// Opening and sizing the file is still blocking, but it's only metadata and it stays on this thread
+		for (int requestIndex = 0; requestIndex < ioUring.m_startingRequests.size(); requestIndex++) {
+			FileReadRequest* request = ioUring.m_startingRequests[requestIndex];
+
+			int fileDescriptor = open(request->m_filePath.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat fileStatus;
+			if ((fileDescriptor < 0) || (fstat(fileDescriptor, &fileStatus) != 0)) {
+				if (fileDescriptor >= 0) close(fileDescriptor);
+				CompleteRead(*request, FileReadStatus::FAILED);
+				continue;
+			}
+
+			request->m_data.resize(static_cast<size_t>(fileStatus.st_size));
+			if (request->m_data.empty()) {
+				close(fileDescriptor);
+				CompleteRead(*request, FileReadStatus::COMPLETED);
+				continue;
+			}
+
+			int readIndex = ioUring.m_freeReads.back();
+			ioUring.m_freeReads.pop_back();
+			AsyncFileIOUring::Read& fileRead = ioUring.m_reads[readIndex];
+			fileRead.m_request = request;
+			fileRead.m_fileDescriptor = fileDescriptor;
+			fileRead.m_bytesRead = 0;
+			QueueRead(ioUring, readIndex);
+		}
+
+		// One syscall submits the whole batch and sleeps until something completes (a read, or the eventfd for new requests)
+		int enterResult = static_cast<int>(syscall(__NR_io_uring_enter, ioUring.m_ringFileDescriptor, ioUring.m_amountToSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+		if (enterResult >= 0) {
+			ioUring.m_amountToSubmit -= static_cast<unsigned>(enterResult);
+		}
+		else if ((errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY)) {
+			ERROR_RECOVERABLE(Stringf("io_uring_enter FAILED WITH ERRNO %d", errno));
+		}
+
+		unsigned completionHead = *ioUring.m_completionHead;
+		unsigned completionTail = __atomic_load_n(ioUring.m_completionTail, __ATOMIC_ACQUIRE);
+		for (; completionHead != completionTail; completionHead++) {
+			io_uring_cqe const& completion = ioUring.m_completionEntries[completionHead & *ioUring.m_completionMask];
+			uint64_t userData = completion.user_data;
+			int readResult = completion.res;
+
+			if (userData == IO_URING_WAKE_UP_USER_DATA) {
+				uint64_t wakeUpValue = 0;
+				(void)read(ioUring.m_wakeUpFileDescriptor, &wakeUpValue, sizeof(wakeUpValue));
+				QueueWakeUpPoll(ioUring);
+				continue;
+			}
+
+			int readIndex = static_cast<int>(userData);
+			AsyncFileIOUring::Read& fileRead = ioUring.m_reads[readIndex];
+			if ((readResult == -EINTR) || (readResult == -EAGAIN)) {
+				QueueRead(ioUring, readIndex);
+				continue;
+			}
+
+			if (readResult > 0) {
+				fileRead.m_bytesRead += static_cast<size_t>(readResult);
+				if (fileRead.m_bytesRead < fileRead.m_request->m_data.size()) {
+					QueueRead(ioUring, readIndex); // Short read, the rest comes in another one
+					continue;
+				}
+			}
+
+			// 0 means the file got shorter since it was sized, what was read is still valid
+			FileReadStatus status = (readResult < 0) ? FileReadStatus::FAILED : FileReadStatus::COMPLETED;
+			if (readResult == 0) {
+				fileRead.m_request->m_data.resize(fileRead.m_bytesRead);
+			}
+
+			close(fileRead.m_fileDescriptor);
+			FileReadRequest* request = fileRead.m_request;
+			fileRead.m_request = nullptr;
+			fileRead.m_fileDescriptor = -1;
+			ioUring.m_freeReads.push_back(readIndex);
+			CompleteRead(*request, status);
+		}
+		__atomic_store_n(ioUring.m_completionHead, completionHead, __ATOMIC_RELEASE);
+	}
+}
+#endif
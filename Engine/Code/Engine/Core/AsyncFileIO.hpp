@@ -0,0 +1,118 @@
+#pragma once
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/JobTask.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ASYNC_FILE_IO_URING_AVAILABLE
+#endif
+
+struct AsyncFileIOUring;
+
+struct AsyncFileIOConfig {
+	JobSystem* m_jobSystem = nullptr; // Completion counters get signaled through it, so jobs can be queued after reads
+	int m_amountOfThreads = 2; // Blocking reader threads of the thread pool backend
+	int m_queueDepth = 64; // Reads in flight at once with io_uring, the rest wait in the pending queue
+	bool m_useIoUring = true; // Linux only, falls back to the thread pool when the kernel doesn't allow it
+};
+
+enum class FileReadStatus {
+	PENDING,
+	COMPLETED,
+	FAILED
+};
+
+// Filled in by the service. Has to stay alive (and in place) until it's done
+struct FileReadRequest {
+	std::string m_filePath;
+	std::vector<uint8_t> m_data;
+	std::atomic<FileReadStatus> m_status = FileReadStatus::PENDING;
+	JobCounter* m_completionCounter = nullptr;
+
+	bool IsDone() const { return m_status.load(std::memory_order_acquire) != FileReadStatus::PENDING; }
+	bool IsSuccessful() const { return m_status.load(std::memory_order_acquire) == FileReadStatus::COMPLETED; }
+};
+
+// Reads whole files without blocking the caller or any JobSystem worker. Every request signals its completion counter once done
+// (successfully or not), so waiting on a read is the same as waiting on jobs: WaitUntilCounterCompletion, QueueJobAfter or co_await
+//
+//	std::vector<FileReadRequest> requests(paths.size());
+//	JobCounter loadedCounter;
+//	g_theAsyncFileIO->ReadFiles(requests.data(), (int)requests.size(), &loadedCounter); // after filling in the paths
+//	g_theJobSystem->QueueLambdaJobAfter([&]() { ParseAll(requests); }, loadedCounter);
+class AsyncFileIO {
+public:
+	AsyncFileIO(AsyncFileIOConfig const& config);
+	~AsyncFileIO();
+	AsyncFileIO(AsyncFileIO const& copy) = delete;
+
+	void Startup();
+	void Shutdown(); // Waits for every read in flight
+
+	void ReadFile(FileReadRequest& request, JobCounter* completionCounter = nullptr);
+	void ReadFiles(FileReadRequest* requests, int amountOfRequests, JobCounter* completionCounter = nullptr); // Queued (and submitted) as one batch
+
+	bool IsUsingIoUring() const { return m_ioUring != nullptr; }
+	int GetAmountOfReadsInFlight() const { return m_amountOfReadsInFlight.load(); }
+
+private:
+	void CompleteRead(FileReadRequest& request, FileReadStatus status);
+	void ReaderThreadMain();
+#if defined(ASYNC_FILE_IO_URING_AVAILABLE)
+	bool StartIoUring();
+	void StopIoUring();
+	void IoUringThreadMain();
+#endif
+
+private:
+	AsyncFileIOConfig m_config;
+
+	std::deque<FileReadRequest*> m_pendingRequests;
+	std::mutex m_pendingRequestsMutex;
+	std::condition_variable m_pendingRequestsCondition;
+	std::atomic<int> m_amountOfReadsInFlight = 0; // Queued or being read
+	std::atomic<bool> m_isQuitting = false;
+
+	std::vector<std::thread*> m_threads; // Reader threads, or the single thread driving io_uring
+	AsyncFileIOUring* m_ioUring = nullptr; // Only ever set where io_uring is available
+};
+
+extern AsyncFileIO* g_theAsyncFileIO;
+
+bool ReadFileBlocking(std::string const& filePath, std::vector<uint8_t>& out_data); // Same read as the thread pool does, false if it can't be read
+
+#if defined(JOB_TASKS_ENABLED)
+// co_await ReadFileAsync(path) inside a Task: suspends without holding a worker, resumes with the file's contents (empty if it failed,
+// or right away and empty when there's no g_theAsyncFileIO)
+class FileReadAwaiter {
+public:
+	explicit FileReadAwaiter(std::string const& filePath) { m_request.m_filePath = filePath; }
+
+	bool await_ready() const noexcept { return false; }
+	template<typename T_Promise>
+	bool await_suspend(std::coroutine_handle<T_Promise> awaitingCoroutine) {
+		if (!g_theAsyncFileIO) {
+			m_request.m_status = FileReadStatus::FAILED;
+			return false; // Nobody to read it, the task goes on without suspending
+		}
+
+		std::coroutine_handle<> coroutine = awaitingCoroutine;
+		JobSystem* jobSystem = awaitingCoroutine.promise().GetJobSystem();
+		GUARANTEE_OR_DIE(jobSystem != nullptr, "ReadFileAsync HAS TO BE AWAITED INSIDE A TASK STARTED ON A JOBSYSTEM");
+		g_theAsyncFileIO->ReadFile(m_request, &m_counter);
+		jobSystem->QueueLambdaJobAfter([coroutine]() { coroutine.resume(); }, m_counter);
+		return true;
+	}
+	std::vector<uint8_t> await_resume() { return std::move(m_request.m_data); }
+
+private:
+	FileReadRequest m_request;
+	JobCounter m_counter;
+};
+
+inline FileReadAwaiter ReadFileAsync(std::string const& filePath)
+{
+	return FileReadAwaiter(filePath);
+}
+#endif
@@ -0,0 +1,156 @@
+#include "Engine/Core/BufferBenchmark.hpp"
+#include "Engine/Core/BufferUtils.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/Vec3.hpp"
+
+constexpr int MIN_BENCHMARK_ELEMENTS = 16; // At least one Mat44
+constexpr int MAX_BENCHMARK_ELEMENTS = 10'000'000;
+
+static volatile int s_bufferChecksumSink = 0; // Written once per run, so the checksummed work can't be optimized away
+
+// Checksum keeps the compiler from dropping the parsed values
+static int GetChecksum(void const* data, size_t amountOfBytes)
+{
+	unsigned char const* bytes = static_cast<unsigned char const*>(data);
+	int checksum = 0;
+	for (size_t byteIndex = 0; byteIndex < amountOfBytes; byteIndex += 64) {
+		checksum += bytes[byteIndex];
+	}
+	return checksum;
+}
+
+// Append calls take small values by copy and bigger ones by reference, so that one stays a template parameter
+template<typename T_Value, typename T_AppendValue>
+static void MeasureScenario(BufferBenchmarkResult& out_result, std::vector<T_Value> const& values,
+	T_AppendValue appendValue, void (BufferWriter::*appendSpan)(T_Value const*, size_t) const,
+	T_Value (BufferParser::*parseValue)(), bool (BufferParser::*parseArray)(T_Value*, size_t), bool isParsing, int& out_checksum)
+{
+	BufferEndianness nativeEndianness = GetNativeEndianness();
+	BufferEndianness flippedEndianness = (nativeEndianness == BufferEndianness::LITTLEENDIAN) ? BufferEndianness::BIGENDIAN : BufferEndianness::LITTLEENDIAN;
+	BufferEndianness endianness = (out_result.m_isFlipped) ? flippedEndianness : nativeEndianness;
+
+	size_t amountOfBytes = values.size() * sizeof(T_Value);
+	out_result.m_amountOfElements = (int)values.size();
+	out_result.m_amountOfBytes = amountOfBytes;
+
+	std::vector<unsigned char> buffer;
+	buffer.reserve(amountOfBytes);
+	std::vector<T_Value> parsedValues(values.size());
+
+	if (isParsing) {
+		BufferWriter writer(buffer, endianness);
+		(writer.*appendSpan)(values.data(), values.size());
+
+		double startTime = GetCurrentTimeSeconds();
+		BufferParser perElementParser(buffer, endianness);
+		for (int valueIndex = 0; valueIndex < values.size(); valueIndex++) {
+			parsedValues[valueIndex] = (perElementParser.*parseValue)();
+		}
+		out_result.m_perElementSeconds = GetCurrentTimeSeconds() - startTime;
+		out_checksum += GetChecksum(parsedValues.data(), amountOfBytes);
+
+		startTime = GetCurrentTimeSeconds();
+		BufferParser bulkParser(buffer, endianness);
+		(bulkParser.*parseArray)(parsedValues.data(), parsedValues.size());
+		out_result.m_bulkSeconds = GetCurrentTimeSeconds() - startTime;
+		out_checksum += GetChecksum(parsedValues.data(), amountOfBytes);
+	}
+	else {
+		// Both start from an empty buffer with the memory already there, so only the appending is timed
+		double startTime = GetCurrentTimeSeconds();
+		BufferWriter perElementWriter(buffer, endianness);
+		for (int valueIndex = 0; valueIndex < values.size(); valueIndex++) {
+			(perElementWriter.*appendValue)(values[valueIndex]);
+		}
+		out_result.m_perElementSeconds = GetCurrentTimeSeconds() - startTime;
+		out_checksum += GetChecksum(buffer.data(), buffer.size());
+
+		buffer.clear();
+		startTime = GetCurrentTimeSeconds();
+		BufferWriter bulkWriter(buffer, endianness);
+		(bulkWriter.*appendSpan)(values.data(), values.size());
+		out_result.m_bulkSeconds = GetCurrentTimeSeconds() - startTime;
+		out_checksum += GetChecksum(buffer.data(), buffer.size());
+	}
+}
+
+template<typename T_Value, typename T_AppendValue>
+static void AddScenarios(BufferBenchmarkResults& out_results, char const* typeName, std::vector<T_Value> const& values,
+	T_AppendValue appendValue, void (BufferWriter::*appendSpan)(T_Value const*, size_t) const,
+	T_Value (BufferParser::*parseValue)(), bool (BufferParser::*parseArray)(T_Value*, size_t), int& out_checksum)
+{
+	for (int isParsing = 1; isParsing >= 0; isParsing--) {
+		for (int isFlipped = 0; isFlipped <= 1; isFlipped++) {
+			BufferBenchmarkResult result;
+			result.m_scenarioName = Stringf("%s %s", (isParsing) ? "Parse" : "Append", typeName);
+			result.m_isFlipped = (isFlipped != 0);
+			MeasureScenario(result, values, appendValue, appendSpan, parseValue, parseArray, isParsing != 0, out_checksum);
+			out_results.push_back(result);
+		}
+	}
+}
+
+double BufferBenchmarkResult::GetPerElementMegabytesPerSecond() const
+{
+	return (m_perElementSeconds > 0.0) ? ((double)m_amountOfBytes / (1024.0 * 1024.0)) / m_perElementSeconds : 0.0;
+}
+
+double BufferBenchmarkResult::GetBulkMegabytesPerSecond() const
+{
+	return (m_bulkSeconds > 0.0) ? ((double)m_amountOfBytes / (1024.0 * 1024.0)) / m_bulkSeconds : 0.0;
+}
+
+void RunBufferBenchmark(BufferBenchmarkResults& out_results, int amountOfElements)
+{
+	std::vector<float> floats(amountOfElements);
+	std::vector<Vec3> positions(amountOfElements);
+	std::vector<Vertex_PCU> vertices(amountOfElements);
+	std::vector<Mat44> matrices(amountOfElements / 16); // Same amount of floats as the float scenario
+	for (int elementIndex = 0; elementIndex < amountOfElements; elementIndex++) {
+		float value = (float)elementIndex * 0.25f;
+		floats[elementIndex] = value;
+		positions[elementIndex] = Vec3(value, -value, value * 2.0f);
+		vertices[elementIndex] = Vertex_PCU(positions[elementIndex], Rgba8((unsigned char)elementIndex, 64, 128, 255), Vec2(value, 1.0f - value));
+	}
+	for (int matrixIndex = 0; matrixIndex < matrices.size(); matrixIndex++) {
+		matrices[matrixIndex].m_values[Mat44::Tx] = (float)matrixIndex;
+	}
+
+	int checksum = 0;
+	AddScenarios<float>(out_results, "float", floats, &BufferWriter::AppendFloat, &BufferWriter::AppendFloatSpan, &BufferParser::ParseFloat, &BufferParser::ParseFloatArray, checksum);
+	AddScenarios<Vec3>(out_results, "Vec3", positions, &BufferWriter::AppendVec3, &BufferWriter::AppendVec3Span, &BufferParser::ParseVec3, &BufferParser::ParseVec3Array, checksum);
+	AddScenarios<Vertex_PCU>(out_results, "PCU", vertices, &BufferWriter::AppendVertexPCU, &BufferWriter::AppendVertexPCUSpan, &BufferParser::ParseVertexPCU, &BufferParser::ParseVertexPCUArray, checksum);
+	AddScenarios<Mat44>(out_results, "Mat44", matrices, &BufferWriter::AppendMat44, &BufferWriter::AppendMat44Span, &BufferParser::ParseMat44, &BufferParser::ParseMat44Array, checksum);
+
+	s_bufferChecksumSink = checksum;
+}
+
+void GetBufferBenchmarkReport(BufferBenchmarkResults const& results, std::vector<std::string>& out_reportLines)
+{
+	for (int resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+		BufferBenchmarkResult const& result = results[resultIndex];
+		double perElementMegabytes = result.GetPerElementMegabytesPerSecond();
+		double bulkMegabytes = result.GetBulkMegabytesPerSecond();
+		double speedUp = (perElementMegabytes > 0.0) ? bulkMegabytes / perElementMegabytes : 0.0;
+		out_reportLines.push_back(Stringf("%-12s %-7s elements: %8d per element: %8.1f MB/s bulk: %8.1f MB/s %6.2fx",
+			result.m_scenarioName.c_str(), (result.m_isFlipped) ? "flipped" : "native", result.m_amountOfElements, perElementMegabytes, bulkMegabytes, speedUp));
+	}
+}
+
+bool Command_BufferBenchmark(EventArgs& args)
+{
+	std::string elementsText = args.GetValue("elements", "");
+	int amountOfElements = ParseClampedInt(elementsText, 1'000'000, MIN_BENCHMARK_ELEMENTS, MAX_BENCHMARK_ELEMENTS);
+
+	BufferBenchmarkResults results;
+	RunBufferBenchmark(results, amountOfElements);
+
+	std::vector<std::string> reportLines;
+	GetBufferBenchmarkReport(results, reportLines);
+	AddDevConsoleReportLines(reportLines);
+
+	return true;
+}
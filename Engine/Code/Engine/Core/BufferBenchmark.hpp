@@ -0,0 +1,24 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+#include <vector>
+
+// BufferParser/BufferWriter one value at a time against the bulk array calls, in native and flipped byte order
+struct BufferBenchmarkResult {
+	std::string m_scenarioName;
+	bool m_isFlipped = false;
+	int m_amountOfElements = 0;
+	size_t m_amountOfBytes = 0;
+	double m_perElementSeconds = 0.0;
+	double m_bulkSeconds = 0.0;
+
+	double GetPerElementMegabytesPerSecond() const;
+	double GetBulkMegabytesPerSecond() const;
+};
+
+typedef std::vector<BufferBenchmarkResult> BufferBenchmarkResults;
+
+void RunBufferBenchmark(BufferBenchmarkResults& out_results, int amountOfElements);
+void GetBufferBenchmarkReport(BufferBenchmarkResults const& results, std::vector<std::string>& out_reportLines);
+
+bool Command_BufferBenchmark(EventArgs& args);
@@ -17,6 +17,28 @@
 #include "Engine/Core/Vertex_PCU.hpp"
 #include "Engine/Core/Vertex_PNCU.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BUFFER_UTILS_X64
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BUFFER_UTILS_TARGET_AVX2
+#else
+#define BUFFER_UTILS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// The bulk calls copy these straight from/to the buffer, so the memory layout has to match what the per value calls write
+static_assert(sizeof(Vec2) == 8, "Vec2 has to be 2 packed floats");
+static_assert(sizeof(Vec3) == 12, "Vec3 has to be 3 packed floats");
+static_assert(sizeof(Vec4) == 16, "Vec4 has to be 4 packed floats");
+static_assert(sizeof(Mat44) == 64, "Mat44 has to be 16 packed floats");
+static_assert((sizeof(Vertex_PCU) == 24) && (offsetof(Vertex_PCU, m_color) == 12), "Vertex_PCU has to be position, color, uv without padding");
+static_assert((sizeof(Vertex_PNCU) == 36) && (offsetof(Vertex_PNCU, m_color) == 24), "Vertex_PNCU has to be position, normal, color, uv without padding");
 
 BufferEndianness GetNativeEndianness()
 {
@@ -59,6 +81,90 @@ void Flip8Bytes(unsigned char* bytesToFlip) {
 
 }
 
+static unsigned int SwapBytes32(unsigned int word)
+{
+#if defined(_MSC_VER)
+	return _byteswap_ulong(word);
+#else
+	return __builtin_bswap32(word);
+#endif
+}
+
+#if defined(BUFFER_UTILS_X64)
+static bool IsAVX2Supported()
+{
+#if defined(_MSC_VER)
+	int cpuInfo[4] = {};
+	__cpuid(cpuInfo, 0);
+	if (cpuInfo[0] < 7) return false;
+
+	// The OS has to save the YMM registers too
+	__cpuid(cpuInfo, 1);
+	bool isOSXSaveEnabled = (cpuInfo[2] & (1 << 27)) != 0;
+	if (!isOSXSaveEnabled || ((_xgetbv(0) & 0x6) != 0x6)) return false;
+
+	__cpuidex(cpuInfo, 7, 0);
+	return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Each returns how many words it swapped, the rest is left for the scalar loop
+BUFFER_UTILS_TARGET_AVX2 static size_t SwapBytes32ArrayAVX2(unsigned char* destination, unsigned char const* source, size_t amountOfWords)
+{
+	__m256i const byteShuffle = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+	size_t wordIndex = 0;
+	for (; (wordIndex + 8) <= amountOfWords; wordIndex += 8) {
+		__m256i words = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + wordIndex * 4));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + wordIndex * 4), _mm256_shuffle_epi8(words, byteShuffle));
+	}
+	return wordIndex;
+}
+
+static size_t SwapBytes32ArraySSE2(unsigned char* destination, unsigned char const* source, size_t amountOfWords)
+{
+	// No byte shuffle before SSSE3: swap the bytes of every 16 bit half, then the halves
+	size_t wordIndex = 0;
+	for (; (wordIndex + 4) <= amountOfWords; wordIndex += 4) {
+		__m128i words = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + wordIndex * 4));
+		__m128i swappedBytes = _mm_or_si128(_mm_slli_epi16(words, 8), _mm_srli_epi16(words, 8));
+		__m128i swappedHalves = _mm_shufflehi_epi16(_mm_shufflelo_epi16(swappedBytes, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + wordIndex * 4), swappedHalves);
+	}
+	return wordIndex;
+}
+#endif
+
+// Byte swaps every 4 byte word, source and destination can be the same memory
+static void SwapBytes32Array(void* destination, void const* source, size_t amountOfWords)
+{
+	unsigned char* destinationBytes = static_cast<unsigned char*>(destination);
+	unsigned char const* sourceBytes = static_cast<unsigned char const*>(source);
+
+	size_t wordIndex = 0;
+#if defined(BUFFER_UTILS_X64)
+	static bool const s_isAVX2Supported = IsAVX2Supported();
+	wordIndex = (s_isAVX2Supported) ? SwapBytes32ArrayAVX2(destinationBytes, sourceBytes, amountOfWords) : SwapBytes32ArraySSE2(destinationBytes, sourceBytes, amountOfWords);
+#endif
+
+	for (; wordIndex < amountOfWords; wordIndex++) {
+		unsigned int word = 0;
+		memcpy(&word, sourceBytes + wordIndex * 4, 4);
+		word = SwapBytes32(word);
+		memcpy(destinationBytes + wordIndex * 4, &word, 4);
+	}
+}
+
+// Colors are bytes, so the word swap of a whole vertex array has to be undone for them
+static void UnswapColors(unsigned char* vertexBytes, size_t amountOfVertices, size_t vertexSize, size_t colorOffset)
+{
+	for (size_t vertexIndex = 0; vertexIndex < amountOfVertices; vertexIndex++) {
+		Flip4Bytes(vertexBytes + vertexIndex * vertexSize + colorOffset);
+	}
+}
+
 BufferParser::BufferParser(std::vector<unsigned char> const& buffer, BufferEndianness endianness) :
 	m_data(buffer.data()),
 	m_size(buffer.size())
@@ -284,18 +390,8 @@ void BufferParser::ParseStringZeroTerminated(std::string& storeStr)
 
 void BufferParser::ParseStringAfter32BitLength(std::string& storeStr)
 {
-	unsigned int strSize = ParseUint32();
-
-	if ((m_currentPosition + strSize) > m_size) {
-		ERROR_RECOVERABLE("TRYING TO PARSE BEYOND BUFFER END");
-		return;
-	}
-
-	for (unsigned int index = 0; index < strSize; index++, m_currentPosition++) {
-		storeStr += m_data[m_currentPosition];
-	}
-
-	m_currentPosition++;
+	std::string_view parsedString = ParseStringView();
+	storeStr.append(parsedString.data(), parsedString.size());
 }
 
 Rgba8 BufferParser::ParseRgba()
@@ -360,21 +456,16 @@ Vec4 BufferParser::ParseVec4()
 
 Vertex_PCU BufferParser::ParseVertexPCU()
 {
-	Vec3 position = ParseVec3();
-	Rgba8 color = ParseRgba();
-	Vec2 uv = ParseVec2();
-
-	return Vertex_PCU(position, color, uv);
+	Vertex_PCU vertex;
+	ParseVertexPCUArray(&vertex, 1);
+	return vertex;
 }
 
 Vertex_PNCU BufferParser::ParseVertexPNCU()
 {
-	Vec3 position = ParseVec3();
-	Vec3 normals = ParseVec3();
-	Rgba8 color = ParseRgba();
-	Vec2 uv = ParseVec2();
-
-	return Vertex_PNCU(position, normals, color, uv);
+	Vertex_PNCU vertex;
+	ParseVertexPNCUArray(&vertex, 1);
+	return vertex;
 }
 
 AABB2 BufferParser::ParseAABB2()
@@ -444,12 +535,146 @@ IntRange BufferParser::ParseIntRange()
 Mat44 BufferParser::ParseMat44()
 {
 	Mat44 newMat;
-	for (int floatInd = 0; floatInd < 16; floatInd++) {
-		newMat.m_values[floatInd] = ParseFloat();
-	}
+	ParseMat44Array(&newMat, 1);
 	return newMat;
 }
 
+std::string_view BufferParser::ParseStringView()
+{
+	unsigned int strSize = ParseUint32();
+
+	char const* strData = reinterpret_cast<char const*>(ConsumeBytes(strSize));
+	if (!strData) return std::string_view();
+
+	return std::string_view(strData, strSize);
+}
+
+std::string_view BufferParser::ParseStringViewZeroTerminated()
+{
+	char const* strData = reinterpret_cast<char const*>(m_data + m_currentPosition);
+	void const* terminator = (m_currentPosition < m_size) ? memchr(strData, '\0', m_size - m_currentPosition) : nullptr;
+	if (!terminator) {
+		ERROR_RECOVERABLE("TRYING TO PARSE BEYOND BUFFER END");
+		return std::string_view();
+	}
+
+	size_t strSize = static_cast<char const*>(terminator) - strData;
+	m_currentPosition += strSize + 1;
+	return std::string_view(strData, strSize);
+}
+
+BufferParser BufferParser::SubParser(size_t offsetFromBeginning, size_t size) const
+{
+	if ((offsetFromBeginning > m_size) || (size > (m_size - offsetFromBeginning))) {
+		ERROR_RECOVERABLE("TRYING TO PARSE BEYOND BUFFER END");
+		return BufferParser(m_data, 0, m_endianness);
+	}
+
+	return BufferParser(m_data + offsetFromBeginning, size, m_endianness);
+}
+
+bool BufferParser::CanViewValues(size_t valueSize, size_t valueAlignment, size_t amountOfValues) const
+{
+	if ((m_currentPosition > m_size) || (amountOfValues > ((m_size - m_currentPosition) / valueSize))) {
+		ERROR_RECOVERABLE("TRYING TO PARSE BEYOND BUFFER END");
+		return false;
+	}
+
+	// Views can't swap bytes in memory they don't own, those have to go through the copying Parse calls
+	if (m_shouldFlipBytes && (valueSize > 1)) {
+		ERROR_RECOVERABLE("CAN'T VIEW VALUES IN PLACE WITH FLIPPED ENDIANNESS");
+		return false;
+	}
+
+	uintptr_t address = reinterpret_cast<uintptr_t>(m_data + m_currentPosition);
+	if ((address % valueAlignment) != 0) {
+		ERROR_RECOVERABLE("CAN'T VIEW MISALIGNED VALUES IN PLACE");
+		return false;
+	}
+	return true;
+}
+
+unsigned char const* BufferParser::ConsumeBytes(size_t amountOfBytes)
+{
+	if ((m_currentPosition > m_size) || (amountOfBytes > (m_size - m_currentPosition))) {
+		ERROR_RECOVERABLE("TRYING TO PARSE BEYOND BUFFER END");
+		return nullptr;
+	}
+
+	unsigned char const* bytes = m_data + m_currentPosition;
+	m_currentPosition += amountOfBytes;
+	return bytes;
+}
+
+bool BufferParser::Parse4ByteWords(void* out_words, size_t amountOfWords)
+{
+	unsigned char const* bytes = ConsumeBytes(amountOfWords * 4);
+	if (!bytes) return false;
+
+	if (m_shouldFlipBytes) {
+		SwapBytes32Array(out_words, bytes, amountOfWords);
+	}
+	else {
+		memcpy(out_words, bytes, amountOfWords * 4);
+	}
+	return true;
+}
+
+bool BufferParser::ParseInt32Array(int* out_values, size_t amountOfValues)
+{
+	return Parse4ByteWords(out_values, amountOfValues);
+}
+
+bool BufferParser::ParseUint32Array(unsigned int* out_values, size_t amountOfValues)
+{
+	return Parse4ByteWords(out_values, amountOfValues);
+}
+
+bool BufferParser::ParseFloatArray(float* out_values, size_t amountOfValues)
+{
+	return Parse4ByteWords(out_values, amountOfValues);
+}
+
+bool BufferParser::ParseVec2Array(Vec2* out_values, size_t amountOfValues)
+{
+	return Parse4ByteWords(out_values, amountOfValues * 2);
+}
+
+bool BufferParser::ParseVec3Array(Vec3* out_values, size_t amountOfValues)
+{
+	return Parse4ByteWords(out_values, amountOfValues * 3);
+}
+
+bool BufferParser::ParseVec4Array(Vec4* out_values, size_t amountOfValues)
+{
+	return Parse4ByteWords(out_values, amountOfValues * 4);
+}
+
+bool BufferParser::ParseVertexPCUArray(Vertex_PCU* out_vertices, size_t amountOfVertices)
+{
+	if (!Parse4ByteWords(out_vertices, amountOfVertices * (sizeof(Vertex_PCU) / 4))) return false;
+
+	if (m_shouldFlipBytes) {
+		UnswapColors(reinterpret_cast<unsigned char*>(out_vertices), amountOfVertices, sizeof(Vertex_PCU), offsetof(Vertex_PCU, m_color));
+	}
+	return true;
+}
+
+bool BufferParser::ParseVertexPNCUArray(Vertex_PNCU* out_vertices, size_t amountOfVertices)
+{
+	if (!Parse4ByteWords(out_vertices, amountOfVertices * (sizeof(Vertex_PNCU) / 4))) return false;
+
+	if (m_shouldFlipBytes) {
+		UnswapColors(reinterpret_cast<unsigned char*>(out_vertices), amountOfVertices, sizeof(Vertex_PNCU), offsetof(Vertex_PNCU, m_color));
+	}
+	return true;
+}
+
+bool BufferParser::ParseMat44Array(Mat44* out_matrices, size_t amountOfMatrices)
+{
+	return Parse4ByteWords(out_matrices, amountOfMatrices * 16);
+}
+
 size_t BufferParser::GetTotalSize() const
 {
 	return m_size;
@@ -485,18 +710,60 @@ BufferWriter::BufferWriter(std::vector<unsigned char>* buffer, BufferEndianness
 	SetEndianness(endianness);
 }
 
+BufferWriter::BufferWriter(void* memory, size_t capacity, BufferEndianness endianness) :
+	m_fixedMemory(static_cast<unsigned char*>(memory)),
+	m_fixedCapacity(capacity)
+{
+	SetEndianness(endianness);
+}
+
 void BufferWriter::OverwriteUint32(unsigned int startingPosition, unsigned int newInt32) const
 {
+	if ((size_t(startingPosition) + 4) > GetSize()) {
+		ERROR_RECOVERABLE("TRYING TO OVERWRITE BEYOND WRITTEN BYTES");
+		return;
+	}
+
 	unsigned char* asArray = (unsigned char*)&newInt32;
 	if (m_shouldFlipBytes) {
 		Flip4Bytes(asArray);
 	}
 
-	(*m_buffer)[startingPosition] = asArray[0];
-	(*m_buffer)[size_t(startingPosition + 1)] = asArray[1];
-	(*m_buffer)[size_t(startingPosition + 2)] = asArray[2];
-	(*m_buffer)[size_t(startingPosition + 3)] = asArray[3];
+	unsigned char* destination = (m_buffer) ? m_buffer->data() : m_fixedMemory;
+	memcpy(destination + startingPosition, asArray, 4);
+}
+
+bool BufferWriter::Reserve(size_t amountOfBytesToAppend) const
+{
+	if (m_buffer) {
+		// Hints given before every chunk still grow geometrically instead of reallocating each time
+		size_t neededCapacity = m_buffer->size() + amountOfBytesToAppend;
+		if (neededCapacity > m_buffer->capacity()) {
+			m_buffer->reserve((neededCapacity > m_buffer->capacity() * 2) ? neededCapacity : m_buffer->capacity() * 2);
+		}
+		return true;
+	}
+
+	return !m_hasOverflowed && (amountOfBytesToAppend <= (m_fixedCapacity - m_fixedSize));
+}
+
+void BufferWriter::Clear() const
+{
+	if (m_buffer) {
+		m_buffer->clear();
+	}
+	m_fixedSize = 0;
+	m_hasOverflowed = false;
+}
+
+size_t BufferWriter::GetSize() const
+{
+	return (m_buffer) ? m_buffer->size() : m_fixedSize;
+}
 
+size_t BufferWriter::GetCapacity() const
+{
+	return (m_buffer) ? m_buffer->capacity() : m_fixedCapacity;
 }
 
 void BufferWriter::SetEndianness(BufferEndianness newEndianness)
@@ -513,18 +780,21 @@ void BufferWriter::SetEndianness(BufferEndianness newEndianness)
 
 void BufferWriter::AppendChar(char charToAdd) const
 {
-	m_buffer->push_back(static_cast<unsigned char>(charToAdd));
+	AppendeByte(static_cast<unsigned char>(charToAdd));
 }
 
 void BufferWriter::AppendeByte(unsigned char byteToAdd) const
 {
-	m_buffer->push_back(byteToAdd);
+	unsigned char* destination = AppendUninitializedBytes(1);
+	if (!destination) return;
+
+	*destination = byteToAdd;
 }
 
 void BufferWriter::AppendBool(bool boolToAdd) const
 {
 	unsigned char boolAsbyte = (boolToAdd) ? 1 : 0;
-	m_buffer->push_back(boolAsbyte);
+	AppendeByte(boolAsbyte);
 }
 
 void BufferWriter::AppendShort(short shortToAdd) const
@@ -534,9 +804,10 @@ void BufferWriter::AppendShort(short shortToAdd) const
 		Flip2Bytes(asArray);
 	}
 
-	m_buffer->push_back(asArray[0]);
-	m_buffer->push_back(asArray[1]);
+	unsigned char* destination = AppendUninitializedBytes(2);
+	if (!destination) return;
 
+	memcpy(destination, asArray, 2);
 }
 void BufferWriter::AppendUShort(unsigned short uShortToAdd) const
 {
@@ -545,8 +816,10 @@ void BufferWriter::AppendUShort(unsigned short uShortToAdd) const
 		Flip2Bytes(asArray);
 	}
 
-	m_buffer->push_back(asArray[0]);
-	m_buffer->push_back(asArray[1]);
+	unsigned char* destination = AppendUninitializedBytes(2);
+	if (!destination) return;
+
+	memcpy(destination, asArray, 2);
 }
 void BufferWriter::AppendDouble(double doubleToAdd) const
 {
@@ -554,7 +827,11 @@ void BufferWriter::AppendDouble(double doubleToAdd) const
 	if (m_shouldFlipBytes) {
 		Flip8Bytes(asArray);
 	}
-	m_buffer->insert(m_buffer->end(), asArray, asArray + 8);
+
+	unsigned char* destination = AppendUninitializedBytes(8);
+	if (!destination) return;
+
+	memcpy(destination, asArray, 8);
 }
 
 void BufferWriter::AppendUint32(unsigned int uint32ToAdd) const
@@ -581,16 +858,20 @@ void BufferWriter::Append4Bytes(unsigned char* bytesToAdd) const
 	if (m_shouldFlipBytes) {
 		Flip4Bytes(bytesToAdd);
 	}
-	m_buffer->insert(m_buffer->end(), bytesToAdd, bytesToAdd + 4);
+
+	unsigned char* destination = AppendUninitializedBytes(4);
+	if (!destination) return;
+
+	memcpy(destination, bytesToAdd, 4);
 }
 
 void BufferWriter::AppendStringZeroTerminated(std::string const& stringToAdd) const
 {
-	for (char stringChar : stringToAdd) {
-		m_buffer->push_back((unsigned char)stringChar);
-	}
-	m_buffer->push_back('\0');
+	// Including the terminator c_str() always has
+	unsigned char* destination = AppendUninitializedBytes(stringToAdd.size() + 1);
+	if (!destination) return;
 
+	memcpy(destination, stringToAdd.c_str(), stringToAdd.size() + 1);
 }
 
 void BufferWriter::AppendStringAfter32BitLength(std::string const& stringToAdd) const
@@ -598,18 +879,21 @@ void BufferWriter::AppendStringAfter32BitLength(std::string const& stringToAdd)
 	int stringSize = (int)stringToAdd.size();
 
 	AppendInt32(stringSize);
-	for (char stringChar : stringToAdd) {
-		m_buffer->push_back((unsigned char)stringChar);
-	}
+	unsigned char* destination = AppendUninitializedBytes(stringToAdd.size());
+	if (!destination) return;
 
+	memcpy(destination, stringToAdd.data(), stringToAdd.size());
 }
 
 void BufferWriter::AppendRgba(Rgba8 const& rgbaToAdd) const
 {
-	m_buffer->push_back(rgbaToAdd.r);
-	m_buffer->push_back(rgbaToAdd.g);
-	m_buffer->push_back(rgbaToAdd.b);
-	m_buffer->push_back(rgbaToAdd.a);
+	unsigned char* destination = AppendUninitializedBytes(4);
+	if (!destination) return;
+
+	destination[0] = rgbaToAdd.r;
+	destination[1] = rgbaToAdd.g;
+	destination[2] = rgbaToAdd.b;
+	destination[3] = rgbaToAdd.a;
 }
 
 void BufferWriter::AppendIntVec2(IntVec2 const& intVec2ToAdd) const
@@ -648,18 +932,12 @@ void BufferWriter::AppendVec4(Vec4 const& vec4ToAdd) const
 
 void BufferWriter::AppendVertexPCU(Vertex_PCU const& vertexToAdd) const
 {
-	AppendVec3(vertexToAdd.m_position);
-	AppendRgba(vertexToAdd.m_color);
-	AppendVec2(vertexToAdd.m_uvTexCoords);
+	AppendVertexPCUSpan(&vertexToAdd, 1);
 }
 
 void BufferWriter::AppendVertexPNCU(Vertex_PNCU const& vertexToAdd) const
 {
-	AppendVec3(vertexToAdd.m_position);
-	AppendVec3(vertexToAdd.m_normal);
-	AppendRgba(vertexToAdd.m_color);
-	AppendVec2(vertexToAdd.m_uvTexCoords);
-
+	AppendVertexPNCUSpan(&vertexToAdd, 1);
 }
 
 void BufferWriter::AppendAABB2(AABB2 const& aabb2ToAdd) const
@@ -713,8 +991,95 @@ void BufferWriter::AppendIntRange(IntRange const& intRangeToAdd) const
 
 void BufferWriter::AppendMat44(Mat44 const& matToAdd) const
 {
-	for (int floatInd = 0; floatInd < 16; floatInd++) {
-		AppendFloat(matToAdd.m_values[floatInd]);
+	AppendMat44Span(&matToAdd, 1);
+}
+
+unsigned char* BufferWriter::AppendUninitializedBytes(size_t amountOfBytes) const
+{
+	if (m_buffer) {
+		// resize grows the capacity geometrically, Reserve avoids even that
+		size_t startingSize = m_buffer->size();
+		m_buffer->resize(startingSize + amountOfBytes);
+		return m_buffer->data() + startingSize;
+	}
+
+	// Once something got dropped nothing after it is written either, a partial stream would parse as garbage
+	if (m_hasOverflowed) return nullptr;
+	if (amountOfBytes > (m_fixedCapacity - m_fixedSize)) {
+		ERROR_RECOVERABLE("BUFFER WRITER OVERFLOWED ITS FIXED MEMORY");
+		m_hasOverflowed = true;
+		return nullptr;
+	}
+
+	unsigned char* destination = m_fixedMemory + m_fixedSize;
+	m_fixedSize += amountOfBytes;
+	return destination;
+}
+
+unsigned char* BufferWriter::Append4ByteWords(void const* words, size_t amountOfWords) const
+{
+	unsigned char* destination = AppendUninitializedBytes(amountOfWords * 4);
+	if (!destination) return nullptr;
+
+	if (m_shouldFlipBytes) {
+		SwapBytes32Array(destination, words, amountOfWords);
 	}
+	else {
+		memcpy(destination, words, amountOfWords * 4);
+	}
+	return destination;
+}
+
+void BufferWriter::AppendInt32Span(int const* values, size_t amountOfValues) const
+{
+	Append4ByteWords(values, amountOfValues);
+}
+
+void BufferWriter::AppendUint32Span(unsigned int const* values, size_t amountOfValues) const
+{
+	Append4ByteWords(values, amountOfValues);
+}
+
+void BufferWriter::AppendFloatSpan(float const* values, size_t amountOfValues) const
+{
+	Append4ByteWords(values, amountOfValues);
+}
+
+void BufferWriter::AppendVec2Span(Vec2 const* values, size_t amountOfValues) const
+{
+	Append4ByteWords(values, amountOfValues * 2);
+}
+
+void BufferWriter::AppendVec3Span(Vec3 const* values, size_t amountOfValues) const
+{
+	Append4ByteWords(values, amountOfValues * 3);
+}
+
+void BufferWriter::AppendVec4Span(Vec4 const* values, size_t amountOfValues) const
+{
+	Append4ByteWords(values, amountOfValues * 4);
+}
+
+void BufferWriter::AppendVertexPCUSpan(Vertex_PCU const* vertices, size_t amountOfVertices) const
+{
+	unsigned char* destination = Append4ByteWords(vertices, amountOfVertices * (sizeof(Vertex_PCU) / 4));
+
+	if (destination && m_shouldFlipBytes) {
+		UnswapColors(destination, amountOfVertices, sizeof(Vertex_PCU), offsetof(Vertex_PCU, m_color));
+	}
+}
+
+void BufferWriter::AppendVertexPNCUSpan(Vertex_PNCU const* vertices, size_t amountOfVertices) const
+{
+	unsigned char* destination = Append4ByteWords(vertices, amountOfVertices * (sizeof(Vertex_PNCU) / 4));
+
+	if (destination && m_shouldFlipBytes) {
+		UnswapColors(destination, amountOfVertices, sizeof(Vertex_PNCU), offsetof(Vertex_PNCU, m_color));
+	}
+}
+
+void BufferWriter::AppendMat44Span(Mat44 const* matrices, size_t amountOfMatrices) const
+{
+	Append4ByteWords(matrices, amountOfMatrices * 16);
 }
 
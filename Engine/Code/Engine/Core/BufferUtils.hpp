@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 enum class BufferEndianness {
 	DEFAULT,
@@ -27,6 +29,23 @@ struct OBB2;
 struct Mat44;
 
 BufferEndianness GetNativeEndianness();
+
+// Read only view of values that stay wherever the parser's memory is (C++17, so no std::span)
+template<typename T_Value>
+struct BufferSpan {
+	BufferSpan() = default;
+	BufferSpan(T_Value const* data, size_t size) : m_data(data), m_size(size) {}
+
+	T_Value const* begin() const { return m_data; }
+	T_Value const* end() const { return m_data + m_size; }
+	T_Value const& operator[](size_t index) const { return m_data[index]; }
+	size_t size() const { return m_size; }
+	bool IsEmpty() const { return m_size == 0; }
+
+	T_Value const* m_data = nullptr;
+	size_t m_size = 0;
+};
+
 class BufferParser {
 public:
 	BufferParser(std::vector<unsigned char> const& buffer, BufferEndianness endianness = BufferEndianness::DEFAULT);
@@ -63,10 +82,34 @@ public:
 	IntRange ParseIntRange();
 	Mat44 ParseMat44();
 
+	// Bulk versions: one bounds check and a memcpy (or one byte swapping pass) for the whole array. False if it runs past the end
+	bool ParseInt32Array(int* out_values, size_t amountOfValues);
+	bool ParseUint32Array(unsigned int* out_values, size_t amountOfValues);
+	bool ParseFloatArray(float* out_values, size_t amountOfValues);
+	bool ParseVec2Array(Vec2* out_values, size_t amountOfValues);
+	bool ParseVec3Array(Vec3* out_values, size_t amountOfValues);
+	bool ParseVec4Array(Vec4* out_values, size_t amountOfValues);
+	bool ParseVertexPCUArray(Vertex_PCU* out_vertices, size_t amountOfVertices);
+	bool ParseVertexPNCUArray(Vertex_PNCU* out_vertices, size_t amountOfVertices);
+	bool ParseMat44Array(Mat44* out_matrices, size_t amountOfMatrices);
+
+	// Zero copy versions, pointing straight into the parsed memory: only valid while that memory is (mapped file, receive buffer...)
+	std::string_view ParseStringView(); // Same layout as ParseStringAfter32BitLength
+	std::string_view ParseStringViewZeroTerminated(); // Terminator is consumed but not part of the view
+	template<typename T_Value>
+	BufferSpan<T_Value> ParseSpan(size_t amountOfValues); // Empty, with nothing consumed, if it runs past the end, is misaligned for T_Value or needs its bytes flipped
+	BufferParser SubParser(size_t offsetFromBeginning, size_t size) const; // Same endianness, offsets in it start at 0
+
 	size_t GetTotalSize() const;
 	size_t GetRemainingSize() const;
+	size_t GetCurrentPosition() const { return m_currentPosition; }
 	BufferEndianness GetEndianness() const { return m_endianness; }
 	void SetEndianness(BufferEndianness newEndianness);
+private:
+	unsigned char const* ConsumeBytes(size_t amountOfBytes); // nullptr if there aren't that many left
+	bool CanViewValues(size_t valueSize, size_t valueAlignment, size_t amountOfValues) const;
+	bool Parse4ByteWords(void* out_words, size_t amountOfWords);
+
 private:
 	bool m_shouldFlipBytes = false;
 	unsigned char const* m_data;
@@ -77,12 +120,30 @@ private:
 };
 
 
+template<typename T_Value>
+BufferSpan<T_Value> BufferParser::ParseSpan(size_t amountOfValues)
+{
+	static_assert(std::is_trivially_copyable_v<T_Value>, "Only plain data can be viewed in place");
+	if (!CanViewValues(sizeof(T_Value), alignof(T_Value), amountOfValues)) return BufferSpan<T_Value>();
+
+	T_Value const* values = reinterpret_cast<T_Value const*>(ConsumeBytes(amountOfValues * sizeof(T_Value)));
+	return BufferSpan<T_Value>(values, amountOfValues);
+}
+
 class BufferWriter {
 public:
 	BufferWriter(std::vector<unsigned char>& buffer, BufferEndianness endianness = BufferEndianness::DEFAULT);
 	BufferWriter(std::vector<unsigned char>* buffer, BufferEndianness endianness = BufferEndianness::DEFAULT);
+	// Writes into memory the caller owns (mapped upload buffer, frame arena...) and never allocates.
+	// Whatever doesn't fit is dropped along with every later append, check HasOverflowed once done
+	BufferWriter(void* memory, size_t capacity, BufferEndianness endianness = BufferEndianness::DEFAULT);
 
 	void OverwriteUint32(unsigned int startingPosition, unsigned int newInt32) const;
+	bool Reserve(size_t amountOfBytesToAppend) const; // Size hint on top of what's written, false if fixed memory can't fit it
+	void Clear() const; // Scratch use: drops what was written but keeps the memory, so a reused buffer stops reallocating
+	size_t GetSize() const;
+	size_t GetCapacity() const;
+	bool HasOverflowed() const { return m_hasOverflowed; }
 	void SetEndianness(BufferEndianness newEndianness);
 	BufferEndianness GetEndianness() const { return m_endianness; }
 
@@ -114,10 +175,27 @@ public:
 	void AppendFloatRange(FloatRange const& floatRangeToAdd) const;
 	void AppendIntRange(IntRange const& intRangeToAdd) const;
 	void AppendMat44(Mat44 const& matToAdd) const;
+
+	// Bulk versions: the buffer grows once and the values are copied (or byte swapped) in one pass
+	void AppendInt32Span(int const* values, size_t amountOfValues) const;
+	void AppendUint32Span(unsigned int const* values, size_t amountOfValues) const;
+	void AppendFloatSpan(float const* values, size_t amountOfValues) const;
+	void AppendVec2Span(Vec2 const* values, size_t amountOfValues) const;
+	void AppendVec3Span(Vec3 const* values, size_t amountOfValues) const;
+	void AppendVec4Span(Vec4 const* values, size_t amountOfValues) const;
+	void AppendVertexPCUSpan(Vertex_PCU const* vertices, size_t amountOfVertices) const;
+	void AppendVertexPNCUSpan(Vertex_PNCU const* vertices, size_t amountOfVertices) const;
+	void AppendMat44Span(Mat44 const* matrices, size_t amountOfMatrices) const;
 private:
 	void Append4Bytes(unsigned char* bytesToAdd) const;
+	unsigned char* AppendUninitializedBytes(size_t amountOfBytes) const; // Where the caller writes them, nullptr once fixed memory overflowed
+	unsigned char* Append4ByteWords(void const* words, size_t amountOfWords) const;
 
-	std::vector<unsigned char>* m_buffer;
+	std::vector<unsigned char>* m_buffer = nullptr; // nullptr when writing into fixed memory
+	unsigned char* m_fixedMemory = nullptr;
+	size_t m_fixedCapacity = 0;
+	mutable size_t m_fixedSize = 0;
+	mutable bool m_hasOverflowed = false;
 	bool m_shouldFlipBytes = false;
 	BufferEndianness m_endianness = BufferEndianness::DEFAULT;
 };
@@ -0,0 +1,306 @@
+#include "Engine/Core/CpuTopology.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+constexpr int MAX_NUMA_NODES_TO_PROBE = 64;
+
+int CpuTopology::GetAmountOfPhysicalCores() const
+{
+	std::vector<int> physicalCoreIds;
+	for (int coreIndex = 0; coreIndex < m_logicalCores.size(); coreIndex++) {
+		int physicalCoreId = m_logicalCores[coreIndex].m_physicalCoreId;
+		if (std::find(physicalCoreIds.begin(), physicalCoreIds.end(), physicalCoreId) == physicalCoreIds.end()) {
+			physicalCoreIds.push_back(physicalCoreId);
+		}
+	}
+	return (int)physicalCoreIds.size();
+}
+
+bool CpuTopology::Detect()
+{
+	m_logicalCores.clear();
+	if (DetectFromOS() && !m_logicalCores.empty()) return true;
+
+	int amountOfLogicalCores = (int)std::thread::hardware_concurrency();
+	SetFallbackTopology((amountOfLogicalCores > 0) ? amountOfLogicalCores : 1);
+	return false;
+}
+
+void CpuTopology::SetFallbackTopology(int amountOfLogicalCores)
+{
+	m_logicalCores.clear();
+	for (int coreIndex = 0; coreIndex < amountOfLogicalCores; coreIndex++) {
+		LogicalCoreInfo coreInfo;
+		coreInfo.m_logicalCoreId = coreIndex;
+		coreInfo.m_physicalCoreId = coreIndex;
+		coreInfo.m_l2CacheId = coreIndex;
+		coreInfo.m_l3CacheId = 0;
+		m_logicalCores.push_back(coreInfo);
+	}
+}
+
+void CpuTopology::GetWorkerCoreOrder(std::vector<int>& out_coreIndexes) const
+{
+	std::vector<int> sortedCores;
+	for (int coreIndex = 0; coreIndex < m_logicalCores.size(); coreIndex++) {
+		sortedCores.push_back(coreIndex);
+	}
+
+	// Neighbours end up next to each other, so consecutive workers share caches
+	std::stable_sort(sortedCores.begin(), sortedCores.end(), [this](int firstIndex, int secondIndex) {
+		LogicalCoreInfo const& first = m_logicalCores[firstIndex];
+		LogicalCoreInfo const& second = m_logicalCores[secondIndex];
+		if (first.m_numaNodeId != second.m_numaNodeId) return first.m_numaNodeId < second.m_numaNodeId;
+		if (first.m_l3CacheId != second.m_l3CacheId) return first.m_l3CacheId < second.m_l3CacheId;
+		if (first.m_l2CacheId != second.m_l2CacheId) return first.m_l2CacheId < second.m_l2CacheId;
+		if (first.m_physicalCoreId != second.m_physicalCoreId) return first.m_physicalCoreId < second.m_physicalCoreId;
+		return first.m_logicalCoreId < second.m_logicalCoreId;
+	});
+
+	// First pass takes one logical core per physical core, SMT siblings only get used once every physical core has a worker
+	std::vector<int> usedPhysicalCores;
+	std::vector<int> smtSiblings;
+	for (int sortedIndex = 0; sortedIndex < sortedCores.size(); sortedIndex++) {
+		int coreIndex = sortedCores[sortedIndex];
+		int physicalCoreId = m_logicalCores[coreIndex].m_physicalCoreId;
+		if (std::find(usedPhysicalCores.begin(), usedPhysicalCores.end(), physicalCoreId) == usedPhysicalCores.end()) {
+			usedPhysicalCores.push_back(physicalCoreId);
+			out_coreIndexes.push_back(coreIndex);
+		}
+		else {
+			smtSiblings.push_back(coreIndex);
+		}
+	}
+
+	out_coreIndexes.insert(out_coreIndexes.end(), smtSiblings.begin(), smtSiblings.end());
+}
+
+int CpuTopology::GetCoreDistance(int firstCoreIndex, int secondCoreIndex) const
+{
+	LogicalCoreInfo const& first = m_logicalCores[firstCoreIndex];
+	LogicalCoreInfo const& second = m_logicalCores[secondCoreIndex];
+
+	if (first.m_logicalCoreId == second.m_logicalCoreId) return 0;
+	if (first.m_physicalCoreId == second.m_physicalCoreId) return 1;
+	if ((first.m_l2CacheId >= 0) && (first.m_l2CacheId == second.m_l2CacheId)) return 2;
+	if ((first.m_l3CacheId >= 0) && (first.m_l3CacheId == second.m_l3CacheId)) return 3;
+	if (first.m_numaNodeId == second.m_numaNodeId) return 4;
+	return 5;
+}
+
+#if defined(_WIN32)
+
+static void GetLogicalCoresInMask(KAFFINITY coreMask, std::vector<int>& out_logicalCoreIds)
+{
+	for (int bitIndex = 0; bitIndex < (int)(sizeof(KAFFINITY) * 8); bitIndex++) {
+		if ((coreMask & ((KAFFINITY)1 << bitIndex)) != 0) {
+			out_logicalCoreIds.push_back(bitIndex);
+		}
+	}
+}
+
+bool CpuTopology::DetectFromOS()
+{
+	DWORD bufferSize = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &bufferSize);
+	if (bufferSize == 0) return false;
+
+	std::vector<unsigned char> buffer(bufferSize);
+	if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &bufferSize)) return false;
+
+	std::map<int, LogicalCoreInfo> coresById;
+	int physicalCoreCount = 0;
+	int l2CacheCount = 0;
+	int l3CacheCount = 0;
+
+	// Cores have to be known before caches and nodes can be assigned to them, and RelationAll doesn't guarantee an order
+	for (int pass = 0; pass < 2; pass++) {
+		DWORD offset = 0;
+		while (offset < bufferSize) {
+			PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX processorInfo = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+			offset += processorInfo->Size;
+
+			std::vector<int> logicalCoreIds;
+			if ((pass == 0) && (processorInfo->Relationship == RelationProcessorCore)) {
+				for (WORD groupIndex = 0; groupIndex < processorInfo->Processor.GroupCount; groupIndex++) {
+					if (processorInfo->Processor.GroupMask[groupIndex].Group != 0) continue;
+					GetLogicalCoresInMask(processorInfo->Processor.GroupMask[groupIndex].Mask, logicalCoreIds);
+				}
+				if (logicalCoreIds.empty()) continue;
+
+				for (int coreIndex = 0; coreIndex < logicalCoreIds.size(); coreIndex++) {
+					LogicalCoreInfo& coreInfo = coresById[logicalCoreIds[coreIndex]];
+					coreInfo.m_logicalCoreId = logicalCoreIds[coreIndex];
+					coreInfo.m_physicalCoreId = physicalCoreCount;
+				}
+				physicalCoreCount++;
+			}
+			else if ((pass == 1) && (processorInfo->Relationship == RelationCache)) {
+				int cacheLevel = processorInfo->Cache.Level;
+				if ((cacheLevel != 2) && (cacheLevel != 3)) continue;
+				if (processorInfo->Cache.GroupMask.Group != 0) continue;
+
+				int cacheId = (cacheLevel == 2) ? l2CacheCount++ : l3CacheCount++;
+				GetLogicalCoresInMask(processorInfo->Cache.GroupMask.Mask, logicalCoreIds);
+				for (int coreIndex = 0; coreIndex < logicalCoreIds.size(); coreIndex++) {
+					std::map<int, LogicalCoreInfo>::iterator coreIt = coresById.find(logicalCoreIds[coreIndex]);
+					if (coreIt == coresById.end()) continue;
+					if (cacheLevel == 2) coreIt->second.m_l2CacheId = cacheId;
+					else coreIt->second.m_l3CacheId = cacheId;
+				}
+			}
+			else if ((pass == 1) && (processorInfo->Relationship == RelationNumaNode)) {
+				if (processorInfo->NumaNode.GroupMask.Group != 0) continue;
+
+				GetLogicalCoresInMask(processorInfo->NumaNode.GroupMask.Mask, logicalCoreIds);
+				for (int coreIndex = 0; coreIndex < logicalCoreIds.size(); coreIndex++) {
+					std::map<int, LogicalCoreInfo>::iterator coreIt = coresById.find(logicalCoreIds[coreIndex]);
+					if (coreIt == coresById.end()) continue;
+					coreIt->second.m_numaNodeId = (int)processorInfo->NumaNode.NodeNumber;
+				}
+			}
+		}
+	}
+
+	for (std::map<int, LogicalCoreInfo>::const_iterator coreIt = coresById.begin(); coreIt != coresById.end(); coreIt++) {
+		m_logicalCores.push_back(coreIt->second);
+	}
+	return !m_logicalCores.empty();
+}
+
+bool PinCurrentThreadToLogicalCore(int logicalCoreId)
+{
+	if ((logicalCoreId < 0) || (logicalCoreId >= (int)(sizeof(DWORD_PTR) * 8))) return false;
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << logicalCoreId) != 0;
+}
+
+#elif defined(__linux__)
+
+static bool ReadSysfsLine(std::string const& path, std::string& out_line)
+{
+	std::ifstream sysfsFile(path);
+	if (!sysfsFile.is_open()) return false;
+	std::getline(sysfsFile, out_line);
+	return true;
+}
+
+// "0-3,8,10-11" style lists, as used all over sysfs
+static void ParseCpuList(std::string const& cpuList, std::vector<int>& out_cpus)
+{
+	size_t rangeStart = 0;
+	while (rangeStart < cpuList.size()) {
+		size_t rangeEnd = cpuList.find(',', rangeStart);
+		if (rangeEnd == std::string::npos) rangeEnd = cpuList.size();
+
+		std::string range = cpuList.substr(rangeStart, rangeEnd - rangeStart);
+		size_t dashIndex = range.find('-');
+		if (!range.empty()) {
+			int firstCpu = atoi(range.c_str());
+			int lastCpu = (dashIndex == std::string::npos) ? firstCpu : atoi(range.c_str() + dashIndex + 1);
+			for (int cpu = firstCpu; cpu <= lastCpu; cpu++) {
+				out_cpus.push_back(cpu);
+			}
+		}
+		rangeStart = rangeEnd + 1;
+	}
+}
+
+bool CpuTopology::DetectFromOS()
+{
+	std::string onlineCpuList;
+	if (!ReadSysfsLine("/sys/devices/system/cpu/online", onlineCpuList)) return false;
+
+	std::vector<int> onlineCpus;
+	ParseCpuList(onlineCpuList, onlineCpus);
+
+	std::map<std::pair<int, int>, int> physicalCoreIds; // (package, core_id) pairs, core_id alone repeats across packages
+	for (int cpuIndex = 0; cpuIndex < onlineCpus.size(); cpuIndex++) {
+		int cpu = onlineCpus[cpuIndex];
+		std::string cpuPath = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+
+		LogicalCoreInfo coreInfo;
+		coreInfo.m_logicalCoreId = cpu;
+
+		std::string packageText, coreText;
+		int packageId = ReadSysfsLine(cpuPath + "/topology/physical_package_id", packageText) ? atoi(packageText.c_str()) : 0;
+		int coreId = ReadSysfsLine(cpuPath + "/topology/core_id", coreText) ? atoi(coreText.c_str()) : cpu;
+
+		std::pair<int, int> physicalCoreKey(packageId, coreId);
+		std::map<std::pair<int, int>, int>::iterator physicalIt = physicalCoreIds.find(physicalCoreKey);
+		if (physicalIt == physicalCoreIds.end()) {
+			physicalIt = physicalCoreIds.insert(std::make_pair(physicalCoreKey, (int)physicalCoreIds.size())).first;
+		}
+		coreInfo.m_physicalCoreId = physicalIt->second;
+
+		// A cache is named after the first cpu sharing it, which is the same for every cpu that does
+		for (int cacheIndex = 0; cacheIndex < 8; cacheIndex++) {
+			std::string cachePath = cpuPath + "/cache/index" + std::to_string(cacheIndex);
+			std::string levelText, sharedCpusText;
+			if (!ReadSysfsLine(cachePath + "/level", levelText)) break;
+			if (!ReadSysfsLine(cachePath + "/shared_cpu_list", sharedCpusText)) continue;
+
+			std::vector<int> sharedCpus;
+			ParseCpuList(sharedCpusText, sharedCpus);
+			if (sharedCpus.empty()) continue;
+
+			int cacheLevel = atoi(levelText.c_str());
+			if (cacheLevel == 2) coreInfo.m_l2CacheId = sharedCpus[0];
+			if (cacheLevel == 3) coreInfo.m_l3CacheId = sharedCpus[0];
+		}
+
+		m_logicalCores.push_back(coreInfo);
+	}
+
+	for (int nodeIndex = 0; nodeIndex < MAX_NUMA_NODES_TO_PROBE; nodeIndex++) {
+		std::string nodeCpuList;
+		if (!ReadSysfsLine("/sys/devices/system/node/node" + std::to_string(nodeIndex) + "/cpulist", nodeCpuList)) continue;
+
+		std::vector<int> nodeCpus;
+		ParseCpuList(nodeCpuList, nodeCpus);
+		for (int coreIndex = 0; coreIndex < m_logicalCores.size(); coreIndex++) {
+			LogicalCoreInfo& coreInfo = m_logicalCores[coreIndex];
+			if (std::find(nodeCpus.begin(), nodeCpus.end(), coreInfo.m_logicalCoreId) != nodeCpus.end()) {
+				coreInfo.m_numaNodeId = nodeIndex;
+			}
+		}
+	}
+
+	return !m_logicalCores.empty();
+}
+
+bool PinCurrentThreadToLogicalCore(int logicalCoreId)
+{
+	if ((logicalCoreId < 0) || (logicalCoreId >= CPU_SETSIZE)) return false;
+
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(logicalCoreId, &cpuSet);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+}
+
+#else
+
+bool CpuTopology::DetectFromOS()
+{
+	return false;
+}
+
+bool PinCurrentThreadToLogicalCore(int logicalCoreId)
+{
+	(void)logicalCoreId;
+	return false;
+}
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+
+struct LogicalCoreInfo {
+	int m_logicalCoreId = -1; // What the OS affinity calls take
+	int m_physicalCoreId = -1; // SMT siblings share it
+	int m_l2CacheId = -1;
+	int m_l3CacheId = -1;
+	int m_numaNodeId = 0;
+};
+
+// Logical cores, and which of them share a physical core, an L2, an L3 or a NUMA node.
+// Windows only sees processor group 0 (up to 64 logical cores)
+class CpuTopology {
+public:
+	bool Detect(); // Falls back to one logical core per physical core and a single shared cache when the OS can't tell
+
+	int GetAmountOfLogicalCores() const { return (int)m_logicalCores.size(); }
+	int GetAmountOfPhysicalCores() const;
+	LogicalCoreInfo const& GetLogicalCore(int coreIndex) const { return m_logicalCores[coreIndex]; }
+
+	// Cores in the order workers should take them: one per physical core (grouped by cache) first, SMT siblings last
+	void GetWorkerCoreOrder(std::vector<int>& out_coreIndexes) const;
+	int GetCoreDistance(int firstCoreIndex, int secondCoreIndex) const; // 0 same core, 1 SMT sibling, 2 same L2, 3 same L3, 4 same NUMA node, 5 anything else
+
+private:
+	bool DetectFromOS();
+	void SetFallbackTopology(int amountOfLogicalCores);
+
+private:
+	std::vector<LogicalCoreInfo> m_logicalCores;
+};
+
+bool PinCurrentThreadToLogicalCore(int logicalCoreId);
@@ -9,6 +9,12 @@
 #include "Engine/Network/RemoteConsole.hpp"
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/BufferBenchmark.hpp"
+#include "Engine/Core/EventProfiler.hpp"
+#include "Engine/Core/JobProfiler.hpp"
+#include "Engine/Core/JobSystemBenchmark.hpp"
+#include "Engine/Core/NamedPropertiesBenchmark.hpp"
 #include "Game//EngineBuildPreferences.hpp"
 
 Rgba8 const DevConsole::ERROR_COLOR = Rgba8(255, 0, 0, 255);
@@ -29,6 +35,14 @@ DevConsole::DevConsole(DevConsoleConfig const& config) :
 	SubscribeEventCallbackFunction("Help", Command_Help);
 	SubscribeEventCallbackFunction("PasteText", Command_Paste_Text);
 	SubscribeEventCallbackFunction("ExecuteXMLFile", this, &DevConsole::EventExecuteXMLFile);
+
+	// Engine diagnostics
+	SubscribeEventCallbackFunction("BufferBenchmark", Command_BufferBenchmark);
+	SubscribeEventCallbackFunction("EventSystemProfile", Command_EventSystemProfile);
+	SubscribeEventCallbackFunction("JobSystemBenchmark", Command_JobSystemBenchmark);
+	SubscribeEventCallbackFunction("JobSystemTrace", Command_JobSystemTrace);
+	SubscribeEventCallbackFunction("NamedPropertiesBenchmark", Command_NamedPropertiesBenchmark);
+
 	m_caretStopwatch.Start(&m_clock, 0.5f);
 	m_commandHistory.resize(m_maxCommandHistory);
 	m_historyIndex = 0;
@@ -692,3 +706,13 @@ bool DevConsole::Command_Paste_Text(EventArgs& args)
 
 	return false;
 }
+
+void AddDevConsoleReportLines(std::vector<std::string> const& reportLines, Rgba8 const& color)
+{
+	for (int lineIndex = 0; lineIndex < reportLines.size(); lineIndex++) {
+		if (g_theConsole) {
+			g_theConsole->AddLine(color, reportLines[lineIndex]);
+		}
+		DebuggerPrintf("%s\n", reportLines[lineIndex].c_str());
+	}
+}
@@ -130,4 +130,7 @@ protected:
 	Buffer* m_textVBuffer = nullptr;
 	Buffer* m_userInputVBuffer = nullptr;
 	Buffer* m_caretVBuffer = nullptr;
-};
\ No newline at end of file
+};
+
+// Benchmark and profiler reports: to the dev console when there is one, and always to the debugger output
+void AddDevConsoleReportLines(std::vector<std::string> const& reportLines, Rgba8 const& color = DevConsole::INFO_MINOR_COLOR);
\ No newline at end of file
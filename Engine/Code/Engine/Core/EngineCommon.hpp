@@ -16,6 +16,7 @@
 class NamedProperties;
 class EventSystem;
 class DevConsole;
+class AsyncFileIO;
 
 extern NamedStrings g_gameConfigBlackboard;
 
@@ -24,6 +25,7 @@ constexpr int ARBITRARILY_LARGE_INT_VALUE = INT_MAX;
 extern DevConsole* g_theConsole;
 extern EventSystem* g_theEventSystem;
 extern JobSystem* g_theJobSystem;
+extern AsyncFileIO* g_theAsyncFileIO;
 extern NetworkSystem* g_theNetwork;
 
 
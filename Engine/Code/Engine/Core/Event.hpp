@@ -0,0 +1,155 @@
+#pragma once
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <vector>
+
+// Statically typed event channel, for events fired often enough that EventArgs (a heap allocated property per key) and virtual
+// EventSubscriptions cost too much. The payload is a plain struct, subscribers are a function pointer plus the object, stored by value.
+// Console commands and anything fired by name keep going through the EventSystem
+//
+//	struct PlayerDamagedPayload { int m_playerIndex; float m_damage; };
+//	Event<PlayerDamagedPayload> m_playerDamagedEvent;
+//	m_playerDamagedEvent.Subscribe<&Hud::OnPlayerDamaged>(m_hud); // bool Hud::OnPlayerDamaged(PlayerDamagedPayload const&)
+//	m_playerDamagedEvent.Fire({ 0, 25.0f });
+//
+// Fire, Subscribe and Unsubscribe belong to one thread. Subscribing and unsubscribing from inside a callback is fine.
+// Jobs that need to notify a typed event can PostEvent to the EventSystem, or queue what they found for the owning thread
+template<typename T_Payload>
+class EventDelegate {
+public:
+	typedef bool (*InvokeFunction)(void* object, T_Payload const& payload);
+
+	EventDelegate() = default;
+	EventDelegate(void* object, InvokeFunction invokeFunction) :
+		m_object(object),
+		m_invokeFunction(invokeFunction) {}
+
+	template<bool (*T_Function)(T_Payload const&)>
+	static EventDelegate FromFunction() {
+		return EventDelegate(nullptr, &InvokeFreeFunction<T_Function>);
+	}
+
+	template<auto T_Method, typename T_ObjectType>
+	static EventDelegate FromMethod(T_ObjectType* objectInstance) {
+		return EventDelegate(objectInstance, &InvokeMethod<T_ObjectType, T_Method>);
+	}
+
+	bool Invoke(T_Payload const& payload) const { return m_invokeFunction(m_object, payload); }
+	bool IsBound() const { return m_invokeFunction != nullptr; }
+	bool BelongsToObject(void const* object) const { return m_object == object; }
+	bool operator==(EventDelegate const& otherDelegate) const { return (m_object == otherDelegate.m_object) && (m_invokeFunction == otherDelegate.m_invokeFunction); }
+
+private:
+	template<bool (*T_Function)(T_Payload const&)>
+	static bool InvokeFreeFunction(void* object, T_Payload const& payload) {
+		(void)object;
+		return T_Function(payload);
+	}
+
+	template<typename T_ObjectType, auto T_Method>
+	static bool InvokeMethod(void* object, T_Payload const& payload) {
+		return (static_cast<T_ObjectType*>(object)->*T_Method)(payload);
+	}
+
+private:
+	void* m_object = nullptr;
+	InvokeFunction m_invokeFunction = nullptr; // One instantiation per subscribed function, so it's also what tells subscriptions apart
+};
+
+template<typename T_Payload>
+class Event {
+public:
+	Event() = default;
+	Event(Event const& copy) = delete;
+
+	template<bool (*T_Function)(T_Payload const&)>
+	void Subscribe() { AddDelegate(EventDelegate<T_Payload>::template FromFunction<T_Function>()); }
+	template<auto T_Method, typename T_ObjectType>
+	void Subscribe(T_ObjectType* objectInstance) { AddDelegate(EventDelegate<T_Payload>::template FromMethod<T_Method>(objectInstance)); }
+
+	template<bool (*T_Function)(T_Payload const&)>
+	void Unsubscribe() { RemoveDelegates(EventDelegate<T_Payload>::template FromFunction<T_Function>(), nullptr); }
+	template<auto T_Method, typename T_ObjectType>
+	void Unsubscribe(T_ObjectType* objectInstance) { RemoveDelegates(EventDelegate<T_Payload>::template FromMethod<T_Method>(objectInstance), nullptr); }
+	void UnsubscribeAll(void const* objectInstance) { RemoveDelegates(EventDelegate<T_Payload>(), objectInstance); } // Every method of that object
+
+	bool Fire(T_Payload const& payload); // Same as FireEvent: stops at the first callback returning true, false if nobody is subscribed
+	int GetAmountOfSubscribers() const;
+	void Reserve(int amountOfSubscribers) { m_delegates.reserve(amountOfSubscribers); } // Then subscribing doesn't allocate at all
+
+private:
+	void AddDelegate(EventDelegate<T_Payload> const& newDelegate);
+	void RemoveDelegates(EventDelegate<T_Payload> const& removedDelegate, void const* removedObject);
+
+private:
+	std::vector<EventDelegate<T_Payload>> m_delegates;
+	int m_firingDepth = 0; // While firing, removed delegates are only unbound, so indices don't shift under the loop
+	bool m_hasUnboundDelegates = false;
+};
+
+template<typename T_Payload>
+bool Event<T_Payload>::Fire(T_Payload const& payload)
+{
+	// Delegates subscribed by the callbacks wait for the next fire
+	int amountOfDelegates = (int)m_delegates.size();
+	if (amountOfDelegates == 0) return false;
+
+	m_firingDepth++;
+	for (int delegateIndex = 0; delegateIndex < amountOfDelegates; delegateIndex++) {
+		EventDelegate<T_Payload> eventDelegate = m_delegates[delegateIndex]; // By value, subscribing can reallocate the vector
+		if (!eventDelegate.IsBound()) continue;
+
+		bool wasConsumed = eventDelegate.Invoke(payload);
+		if (wasConsumed) break;
+	}
+	m_firingDepth--;
+
+	if ((m_firingDepth == 0) && m_hasUnboundDelegates) {
+		for (int delegateIndex = (int)m_delegates.size() - 1; delegateIndex >= 0; delegateIndex--) {
+			if (!m_delegates[delegateIndex].IsBound()) {
+				m_delegates.erase(m_delegates.begin() + delegateIndex);
+			}
+		}
+		m_hasUnboundDelegates = false;
+	}
+
+	return true;
+}
+
+template<typename T_Payload>
+int Event<T_Payload>::GetAmountOfSubscribers() const
+{
+	int amountOfSubscribers = 0;
+	for (int delegateIndex = 0; delegateIndex < m_delegates.size(); delegateIndex++) {
+		if (m_delegates[delegateIndex].IsBound()) amountOfSubscribers++;
+	}
+	return amountOfSubscribers;
+}
+
+template<typename T_Payload>
+void Event<T_Payload>::AddDelegate(EventDelegate<T_Payload> const& newDelegate)
+{
+	for (int delegateIndex = 0; delegateIndex < m_delegates.size(); delegateIndex++) {
+		if (m_delegates[delegateIndex] == newDelegate) {
+			ERROR_AND_DIE("THERE WAS AN ATTEMPT TO DOUBLE SUBSCRIBE A FUNCTION TO AN EVENT");
+		}
+	}
+	m_delegates.push_back(newDelegate);
+}
+
+template<typename T_Payload>
+void Event<T_Payload>::RemoveDelegates(EventDelegate<T_Payload> const& removedDelegate, void const* removedObject)
+{
+	for (int delegateIndex = (int)m_delegates.size() - 1; delegateIndex >= 0; delegateIndex--) {
+		EventDelegate<T_Payload> const& eventDelegate = m_delegates[delegateIndex];
+		bool isRemoved = (removedObject) ? (eventDelegate.IsBound() && eventDelegate.BelongsToObject(removedObject)) : (eventDelegate == removedDelegate);
+		if (!isRemoved) continue;
+
+		if (m_firingDepth > 0) {
+			m_delegates[delegateIndex] = EventDelegate<T_Payload>();
+			m_hasUnboundDelegates = true;
+		}
+		else {
+			m_delegates.erase(m_delegates.begin() + delegateIndex);
+		}
+	}
+}
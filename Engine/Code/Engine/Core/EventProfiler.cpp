@@ -0,0 +1,161 @@
+#include "Engine/Core/EventProfiler.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+
+static std::atomic<int> s_amountOfProfiledThreads = 0;
+static thread_local int t_profiledThreadIndex = -1;
+
+EventProfiler::EventProfiler(int maxAmountOfEvents, int maxTimelineEvents) :
+	m_maxAmountOfEvents(maxAmountOfEvents),
+	m_maxTimelineEvents(maxTimelineEvents)
+{
+	m_eventCounters = new EventProfileCounters[maxAmountOfEvents];
+	m_amountOfUnhandledFires = new std::atomic<int>[maxAmountOfEvents];
+	for (int eventIndex = 0; eventIndex < maxAmountOfEvents; eventIndex++) {
+		m_amountOfUnhandledFires[eventIndex] = 0;
+	}
+
+	m_timeline.reserve(maxTimelineEvents);
+	m_captureStartTime = GetCurrentTimeSeconds();
+}
+
+EventProfiler::~EventProfiler()
+{
+	delete[] m_eventCounters;
+	m_eventCounters = nullptr;
+	delete[] m_amountOfUnhandledFires;
+	m_amountOfUnhandledFires = nullptr;
+}
+
+void EventProfiler::RecordTimelineEvent(EventTimelineEvent const& timelineEvent)
+{
+	m_timelineMutex.lock(); // lock
+	if ((int)m_timeline.size() < m_maxTimelineEvents) {
+		m_timeline.push_back(timelineEvent);
+	}
+	else {
+		m_amountOfDroppedEvents++;
+	}
+	m_timelineMutex.unlock(); // unlock
+}
+
+void EventProfiler::GetTimeline(std::vector<EventTimelineEvent>& out_timeline, int& out_amountOfDroppedEvents) const
+{
+	m_timelineMutex.lock(); // lock
+	out_timeline = m_timeline;
+	out_amountOfDroppedEvents = m_amountOfDroppedEvents;
+	m_timelineMutex.unlock(); // unlock
+}
+
+void EventProfiler::Reset()
+{
+	for (int eventIndex = 0; eventIndex < m_maxAmountOfEvents; eventIndex++) {
+		m_eventCounters[eventIndex].Reset();
+		m_amountOfUnhandledFires[eventIndex] = 0;
+	}
+
+	m_timelineMutex.lock(); // lock
+	m_timeline.clear();
+	m_amountOfDroppedEvents = 0;
+	m_captureStartTime = GetCurrentTimeSeconds();
+	m_timelineMutex.unlock(); // unlock
+}
+
+int EventProfiler::GetCurrentThreadIndex()
+{
+	if (t_profiledThreadIndex < 0) {
+		t_profiledThreadIndex = s_amountOfProfiledThreads.fetch_add(1);
+	}
+	return t_profiledThreadIndex;
+}
+
+void WriteEventChromeTrace(EventSystem const& eventSystem, std::string& out_traceJson)
+{
+	EventProfiler const* eventProfiler = eventSystem.GetProfiler();
+
+	std::vector<EventTimelineEvent> timeline;
+	int amountOfDroppedEvents = 0;
+	eventProfiler->GetTimeline(timeline, amountOfDroppedEvents);
+
+	// Same layout as the JobSystem trace: one row per thread that fired something, handlers nested under their fire
+	out_traceJson = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out_traceJson += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"EventSystem\"}}";
+
+	for (int eventIndex = 0; eventIndex < timeline.size(); eventIndex++) {
+		EventTimelineEvent const& timelineEvent = timeline[eventIndex];
+		double startMicroseconds = (timelineEvent.m_startTime - eventProfiler->GetCaptureStartTime()) * 1'000'000.0;
+		double durationMicroseconds = (timelineEvent.m_endTime - timelineEvent.m_startTime) * 1'000'000.0;
+
+		std::string eventName = eventSystem.GetEventName(EventId(timelineEvent.m_eventIndex));
+		if (timelineEvent.m_handlerIndex >= 0) {
+			eventName += Stringf(" handler %d", timelineEvent.m_handlerIndex);
+		}
+
+		out_traceJson += ",\n{\"name\":";
+		AppendJsonString(out_traceJson, eventName.c_str());
+		out_traceJson += Stringf(",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":2,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", (timelineEvent.m_handlerIndex >= 0) ? "Handler" : "Event", timelineEvent.m_threadIndex, startMicroseconds, durationMicroseconds);
+		out_traceJson += Stringf(",\"args\":{\"consumed\":%s}}", timelineEvent.m_wasConsumed ? "true" : "false");
+	}
+
+	out_traceJson += Stringf(",\n{\"name\":\"dropped\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"amountOfDroppedEvents\":%d}}", amountOfDroppedEvents);
+	out_traceJson += "\n]}\n";
+}
+
+bool ExportEventChromeTrace(EventSystem const& eventSystem, std::string const& filePath)
+{
+	std::string traceJson;
+	WriteEventChromeTrace(eventSystem, traceJson);
+
+	std::vector<uint8_t> fileBuffer(traceJson.begin(), traceJson.end());
+	return FileWriteFromBuffer(fileBuffer, filePath) == 0;
+}
+
+void GetEventProfileReport(std::vector<EventProfileStats> const& eventStats, std::vector<std::string>& out_reportLines)
+{
+	out_reportLines.push_back(Stringf("EventSystem profile: %d events fired, most expensive first", (int)eventStats.size()));
+
+	for (int statsIndex = 0; statsIndex < eventStats.size(); statsIndex++) {
+		EventProfileStats const& stats = eventStats[statsIndex];
+		out_reportLines.push_back(Stringf("  %-24s %7d fires %6d consumed %6d unhandled %10.3f ms total %9.1f us max",
+			stats.m_eventName.c_str(), stats.m_amountOfFires, stats.m_amountOfConsumedFires, stats.m_amountOfUnhandledFires, stats.m_totalSeconds * 1000.0, stats.m_maxSeconds * 1'000'000.0));
+
+		for (int handlerIndex = 0; handlerIndex < stats.m_handlerStats.size(); handlerIndex++) {
+			EventHandlerProfileStats const& handlerStats = stats.m_handlerStats[handlerIndex];
+			out_reportLines.push_back(Stringf("    %d: %-32s %7d calls %6d consumed %10.3f ms total %9.1f us max",
+				handlerIndex, handlerStats.m_handlerName.c_str(), handlerStats.m_amountOfCalls, handlerStats.m_amountOfConsumes, handlerStats.m_totalSeconds * 1000.0, handlerStats.m_maxSeconds * 1'000'000.0));
+		}
+	}
+}
+
+bool Command_EventSystemProfile(EventArgs& args)
+{
+	if (!g_theEventSystem || !g_theEventSystem->GetProfiler()) {
+		if (g_theConsole) {
+			g_theConsole->AddLine(DevConsole::ERROR_COLOR, "EventSystem profiling is off, enable it with EventSystemConfig::m_enableProfiling");
+		}
+		return false;
+	}
+
+	std::string filePath = args.GetValue("file", "Saved/EventSystemTrace.json");
+	bool shouldReset = args.GetValue("reset", "false") == "true";
+
+	std::vector<EventProfileStats> eventStats;
+	g_theEventSystem->GetEventProfileStats(eventStats);
+
+	std::vector<std::string> reportLines;
+	GetEventProfileReport(eventStats, reportLines);
+	if (ExportEventChromeTrace(*g_theEventSystem, filePath)) {
+		reportLines.push_back(Stringf("Chrome trace written to %s", filePath.c_str()));
+	}
+
+	if (shouldReset) {
+		g_theEventSystem->ResetEventProfile();
+	}
+
+	AddDevConsoleReportLines(reportLines);
+
+	return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+
+struct EventHandlerProfileStats {
+	std::string m_handlerName;
+	int m_amountOfCalls = 0;
+	int m_amountOfConsumes = 0;
+	double m_totalSeconds = 0.0;
+	double m_maxSeconds = 0.0;
+};
+
+struct EventProfileStats {
+	std::string m_eventName;
+	int m_amountOfFires = 0; // Including the unhandled ones
+	int m_amountOfConsumedFires = 0; // A handler returned true and the rest were skipped
+	int m_amountOfUnhandledFires = 0; // Nobody was subscribed
+	double m_totalSeconds = 0.0;
+	double m_maxSeconds = 0.0;
+	std::vector<EventHandlerProfileStats> m_handlerStats; // In subscription order
+};
+
+// One fire, or one handler inside it
+struct EventTimelineEvent {
+	int m_eventIndex = -1;
+	int m_handlerIndex = -1; // -1 for the whole fire
+	int m_threadIndex = 0;
+	double m_startTime = 0.0;
+	double m_endTime = 0.0;
+	bool m_wasConsumed = false;
+};
+
+// Created by the EventSystem when profiling is enabled. Counters are atomics (per event here, per handler in the subscription),
+// only the timeline kept for the trace export takes a lock
+class EventProfiler {
+public:
+	EventProfiler(int maxAmountOfEvents, int maxTimelineEvents);
+	~EventProfiler();
+	EventProfiler(EventProfiler const& copy) = delete;
+
+	EventProfileCounters& GetEventCounters(EventId eventId) { return m_eventCounters[eventId.GetIndex()]; }
+	void RecordUnhandledFire(EventId eventId) { m_amountOfUnhandledFires[eventId.GetIndex()].fetch_add(1, std::memory_order_relaxed); }
+	int GetAmountOfUnhandledFires(EventId eventId) const { return m_amountOfUnhandledFires[eventId.GetIndex()].load(std::memory_order_relaxed); }
+	void RecordTimelineEvent(EventTimelineEvent const& timelineEvent);
+	void GetTimeline(std::vector<EventTimelineEvent>& out_timeline, int& out_amountOfDroppedEvents) const;
+	double GetCaptureStartTime() const { return m_captureStartTime; }
+	void Reset(); // Event counters and timeline, handler counters are reset by the EventSystem
+
+	static int GetCurrentThreadIndex();
+
+private:
+	int m_maxAmountOfEvents = 0;
+	EventProfileCounters* m_eventCounters = nullptr;
+	std::atomic<int>* m_amountOfUnhandledFires = nullptr;
+
+	mutable std::mutex m_timelineMutex;
+	std::vector<EventTimelineEvent> m_timeline;
+	int m_maxTimelineEvents = 0;
+	int m_amountOfDroppedEvents = 0;
+	double m_captureStartTime = 0.0;
+};
+
+void WriteEventChromeTrace(EventSystem const& eventSystem, std::string& out_traceJson);
+bool ExportEventChromeTrace(EventSystem const& eventSystem, std::string const& filePath);
+void GetEventProfileReport(std::vector<EventProfileStats> const& eventStats, std::vector<std::string>& out_reportLines);
+
+bool Command_EventSystemProfile(EventArgs& args);
@@ -1,9 +1,64 @@
 #include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/EventProfiler.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <thread>
 
 EventSystem* g_theEventSystem = nullptr;
 
+static std::atomic<int> s_amountOfEventReaderThreads = 0;
+static thread_local int t_eventReaderSlot = -1;
+static thread_local int t_eventReadingDepth = 0; // Fires this thread is inside of
+static std::atomic<int> s_amountOfEventSystems = 0;
+static thread_local PostedEventQueue* t_postedEventQueue = nullptr;
+static thread_local int t_postedEventQueueOwnerIndex = -1;
+
+struct PostedEvent {
+	EventId m_eventId;
+	EventArgs m_args;
+	uint64_t m_postIndex = 0; // Order across every thread's queue
+	bool m_coalesce = false;
+	PostedEvent* m_nextPostedEvent = nullptr;
+};
+
+#pragma warning(push)
+#pragma warning(disable : 4324) // Padded to a full cache line on purpose
+// Only its thread pushes and only the dispatching thread takes everything at once, so the head is all they share
+struct alignas(64) PostedEventQueue {
+	std::atomic<PostedEvent*> m_head = nullptr; // Newest first
+};
+#pragma warning(pop)
+
+static int GetEventReaderSlot()
+{
+	if (t_eventReaderSlot < 0) {
+		t_eventReaderSlot = s_amountOfEventReaderThreads.fetch_add(1) % EVENT_READER_SLOTS;
+	}
+	return t_eventReaderSlot;
+}
+
+void EventProfileCounters::Record(int64_t nanoseconds, bool wasConsumed)
+{
+	m_amountOfCalls.fetch_add(1, std::memory_order_relaxed);
+	if (wasConsumed) m_amountOfConsumes.fetch_add(1, std::memory_order_relaxed);
+	m_totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+	int64_t maxNanoseconds = m_maxNanoseconds.load(std::memory_order_relaxed);
+	while ((nanoseconds > maxNanoseconds) && !m_maxNanoseconds.compare_exchange_weak(maxNanoseconds, nanoseconds, std::memory_order_relaxed)) {
+	}
+}
+
+void EventProfileCounters::Reset()
+{
+	m_amountOfCalls = 0;
+	m_amountOfConsumes = 0;
+	m_totalNanoseconds = 0;
+	m_maxNanoseconds = 0;
+}
+
 EventFuncSubscription::EventFuncSubscription(EventCallbackFunction callbackFunction) :
 	m_callbackFunction(callbackFunction)
 {
@@ -21,14 +76,42 @@ bool EventFuncSubscription::IsSameFunction(void* otherFunction) const
 	return m_callbackFunction == *otherFuncAsCallback;
 }
 
+std::string EventFuncSubscription::GetName() const
+{
+	return Stringf("Function %p", (void*)m_callbackFunction);
+}
+
 EventSystem::EventSystem(EventSystemConfig const& config) :
 	m_config(config)
 {
+	if (m_config.m_maxAmountOfEvents < 1) m_config.m_maxAmountOfEvents = 1;
+	m_registeredEvents = new RegisteredEvent*[m_config.m_maxAmountOfEvents];
+	m_eventIdsByName.reserve(m_config.m_maxAmountOfEvents);
+	m_eventSystemIndex = s_amountOfEventSystems.fetch_add(1);
+
+	if (m_config.m_enableProfiling) {
+		m_profiler = new EventProfiler(m_config.m_maxAmountOfEvents, m_config.m_maxProfiledFires);
+	}
 }
 
 EventSystem::~EventSystem()
 {
+	int amountOfRegisteredEvents = m_amountOfRegisteredEvents.load();
+	for (int eventIndex = 0; eventIndex < amountOfRegisteredEvents; eventIndex++) {
+		delete m_registeredEvents[eventIndex]->m_subscriptions.load();
+		delete m_registeredEvents[eventIndex];
+	}
+	delete[] m_registeredEvents;
+	m_registeredEvents = nullptr;
 
+	DiscardPostedEvents();
+	for (int queueIndex = 0; queueIndex < m_postedEventQueues.size(); queueIndex++) {
+		delete m_postedEventQueues[queueIndex];
+	}
+	m_postedEventQueues.clear();
+
+	delete m_profiler;
+	m_profiler = nullptr;
 }
 
 void EventSystem::Startup()
@@ -37,146 +120,583 @@ void EventSystem::Startup()
 
 void EventSystem::Shutdown()
 {
-	for (auto it = m_subscriptionListByEventName.begin(); it != m_subscriptionListByEventName.end(); it++) {
-		SubscriptionList& subList = it->second;
-		for (int index = 0; index < subList.size(); index++) {
-			EventSubscription*& eventSub = subList[index];
-			delete eventSub;
+	DiscardPostedEvents();
+
+	m_subsListMutex.lock(); // lock
+
+	// Nothing fires anymore, so snapshots go right away. Registered events stay, EventIds cached by other systems remain valid until the EventSystem is deleted
+	int amountOfRegisteredEvents = m_amountOfRegisteredEvents.load();
+	for (int eventIndex = 0; eventIndex < amountOfRegisteredEvents; eventIndex++) {
+		SubscriptionList const* subList = m_registeredEvents[eventIndex]->m_subscriptions.exchange(nullptr);
+		if (!subList) continue;
+
+		for (int index = 0; index < subList->size(); index++) {
+			delete (*subList)[index];
 		}
-		subList.clear();
+		delete subList;
+	}
+
+	for (int retiredIndex = 0; retiredIndex < m_retiredSubscriptions.size(); retiredIndex++) {
+		delete m_retiredSubscriptions[retiredIndex].m_subscriptionList;
+		delete m_retiredSubscriptions[retiredIndex].m_subscription;
 	}
+	m_retiredSubscriptions.clear();
+
+	m_subsListMutex.unlock(); // unlock
 }
 
 void EventSystem::BeginFrame()
 {
+	DispatchQueuedEvents();
 }
 
 void EventSystem::EndFrame()
 {
+	DispatchQueuedEvents();
+
+	// Changes normally clean up after each other, this catches the last ones once their readers are gone
+	m_subsListMutex.lock(); // lock
+	if (!m_retiredSubscriptions.empty()) {
+		ReclaimRetiredSubscriptions();
+	}
+	m_subsListMutex.unlock(); // unlock
 }
 
 void EventSystem::GetRegisteredEventNames(std::vector< std::string >& outNames) const
 {
 	m_subsListMutex.lock();
-	outNames.reserve(m_subscriptionListByEventName.size());
-	for (std::map<std::string, SubscriptionList>::const_iterator iter = m_subscriptionListByEventName.begin(); iter != m_subscriptionListByEventName.end(); iter++) {
-		SubscriptionList const& eventSubList = iter->second;
-		if (eventSubList.size() > 0) {
-			outNames.push_back(iter->first);
+
+	int amountOfRegisteredEvents = m_amountOfRegisteredEvents.load();
+	outNames.reserve(outNames.size() + amountOfRegisteredEvents);
+	for (int eventIndex = 0; eventIndex < amountOfRegisteredEvents; eventIndex++) {
+		RegisteredEvent const* registeredEvent = m_registeredEvents[eventIndex];
+		SubscriptionList const* subList = registeredEvent->m_subscriptions.load();
+		if (subList && (subList->size() > 0)) {
+			outNames.push_back(registeredEvent->m_name);
 		}
 	}
 
 	m_subsListMutex.unlock();
+
+	// Same order as when they were kept in a map
+	std::sort(outNames.begin(), outNames.end());
 }
 
+int EventSystem::GetAmountOfRetiredSubscriptions() const
+{
+	m_subsListMutex.lock(); // lock
+	int amountOfRetiredSubscriptions = (int)m_retiredSubscriptions.size();
+	m_subsListMutex.unlock(); // unlock
 
-void EventSystem::SubscribeEventCallbackFunction(std::string const& eventName, EventCallbackFunction functionPtr)
+	return amountOfRetiredSubscriptions;
+}
+
+void EventSystem::GetEventProfileStats(std::vector<EventProfileStats>& out_eventStats) const
 {
-	EventFuncSubscription* newSubscription = new EventFuncSubscription(functionPtr);
+	if (!m_profiler) return;
+
+	// Handlers can't be deleted while reading, so their counters stay valid even if they're unsubscribed meanwhile
+	int readerToken = BeginReadingSubscriptions();
+
+	int amountOfRegisteredEvents = m_amountOfRegisteredEvents.load(std::memory_order_acquire);
+	for (int eventIndex = 0; eventIndex < amountOfRegisteredEvents; eventIndex++) {
+		EventId eventId(eventIndex);
+		EventProfileCounters const& eventCounters = m_profiler->GetEventCounters(eventId);
+		int amountOfUnhandledFires = m_profiler->GetAmountOfUnhandledFires(eventId);
+		int amountOfHandledFires = eventCounters.m_amountOfCalls.load(std::memory_order_relaxed);
+		if ((amountOfHandledFires + amountOfUnhandledFires) == 0) continue;
+
+		EventProfileStats eventStats;
+		eventStats.m_eventName = m_registeredEvents[eventIndex]->m_name;
+		eventStats.m_amountOfFires = amountOfHandledFires + amountOfUnhandledFires;
+		eventStats.m_amountOfConsumedFires = eventCounters.m_amountOfConsumes.load(std::memory_order_relaxed);
+		eventStats.m_amountOfUnhandledFires = amountOfUnhandledFires;
+		eventStats.m_totalSeconds = (double)eventCounters.m_totalNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+		eventStats.m_maxSeconds = (double)eventCounters.m_maxNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+
+		SubscriptionList const* eventSubList = m_registeredEvents[eventIndex]->m_subscriptions.load();
+		if (eventSubList) {
+			for (int subIndex = 0; subIndex < eventSubList->size(); subIndex++) {
+				EventSubscription const* subscription = (*eventSubList)[subIndex];
+				EventProfileCounters const& handlerCounters = subscription->m_profileCounters;
+
+				EventHandlerProfileStats handlerStats;
+				handlerStats.m_handlerName = subscription->GetName();
+				handlerStats.m_amountOfCalls = handlerCounters.m_amountOfCalls.load(std::memory_order_relaxed);
+				handlerStats.m_amountOfConsumes = handlerCounters.m_amountOfConsumes.load(std::memory_order_relaxed);
+				handlerStats.m_totalSeconds = (double)handlerCounters.m_totalNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+				handlerStats.m_maxSeconds = (double)handlerCounters.m_maxNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+				eventStats.m_handlerStats.push_back(handlerStats);
+			}
+		}
+
+		out_eventStats.push_back(eventStats);
+	}
+
+	EndReadingSubscriptions(readerToken);
+
+	std::sort(out_eventStats.begin(), out_eventStats.end(), [](EventProfileStats const& statsA, EventProfileStats const& statsB) {
+		return statsA.m_totalSeconds > statsB.m_totalSeconds;
+		});
+}
+
+void EventSystem::ResetEventProfile()
+{
+	if (!m_profiler) return;
 
+	int readerToken = BeginReadingSubscriptions();
+	int amountOfRegisteredEvents = m_amountOfRegisteredEvents.load(std::memory_order_acquire);
+	for (int eventIndex = 0; eventIndex < amountOfRegisteredEvents; eventIndex++) {
+		SubscriptionList const* eventSubList = m_registeredEvents[eventIndex]->m_subscriptions.load();
+		if (!eventSubList) continue;
+
+		for (int subIndex = 0; subIndex < eventSubList->size(); subIndex++) {
+			(*eventSubList)[subIndex]->m_profileCounters.Reset();
+		}
+	}
+	EndReadingSubscriptions(readerToken);
+
+	m_profiler->Reset();
+}
+
+EventId EventSystem::RegisterEvent(std::string const& eventName)
+{
+	m_subsListMutex.lock(); // lock
+	EventId eventId = InternEventName(eventName);
+	m_subsListMutex.unlock(); // unlock
+
+	return eventId;
+}
+
+EventId EventSystem::FindEventId(std::string const& eventName) const
+{
+	EventId eventId;
+
+	m_subsListMutex.lock(); // lock
+	auto iter = m_eventIdsByName.find(eventName);
+	if (iter != m_eventIdsByName.end()) {
+		eventId = iter->second;
+	}
+	m_subsListMutex.unlock(); // unlock
+
+	return eventId;
+}
+
+std::string const& EventSystem::GetEventName(EventId eventId) const
+{
+	static std::string const invalidEventName = "";
+
+	RegisteredEvent const* registeredEvent = GetRegisteredEvent(eventId);
+	if (!registeredEvent) return invalidEventName;
+	return registeredEvent->m_name;
+}
+
+EventId EventSystem::InternEventName(std::string const& eventName)
+{
+	auto iter = m_eventIdsByName.find(eventName);
+	if (iter != m_eventIdsByName.end()) return iter->second;
+
+	int amountOfRegisteredEvents = m_amountOfRegisteredEvents.load(std::memory_order_relaxed);
+	if (amountOfRegisteredEvents >= m_config.m_maxAmountOfEvents) {
+		ThrowError(Stringf("TOO MANY EVENTS REGISTERED, RAISE EventSystemConfig::m_maxAmountOfEvents (%d)", m_config.m_maxAmountOfEvents));
+	}
+
+	RegisteredEvent* registeredEvent = new RegisteredEvent();
+	registeredEvent->m_name = eventName;
+	m_registeredEvents[amountOfRegisteredEvents] = registeredEvent;
+
+	// Published after the entry is written, so GetRegisteredEvent never sees an index without its entry
+	EventId eventId(amountOfRegisteredEvents);
+	m_eventIdsByName[eventName] = eventId;
+	m_amountOfRegisteredEvents.store(amountOfRegisteredEvents + 1, std::memory_order_release);
+
+	return eventId;
+}
+
+RegisteredEvent* EventSystem::GetRegisteredEvent(EventId eventId) const
+{
+	if (!eventId.IsValid()) return nullptr;
+	if (eventId.GetIndex() >= m_amountOfRegisteredEvents.load(std::memory_order_acquire)) return nullptr;
+	return m_registeredEvents[eventId.GetIndex()];
+}
+
+void EventSystem::AddSubscription(std::string const& eventName, EventSubscription* newSubscription, void* functionPtr)
+{
 	m_subsListMutex.lock();
 
-	std::map<std::string, SubscriptionList>::iterator iter = m_subscriptionListByEventName.find(eventName);
-	if (iter == m_subscriptionListByEventName.end()) {
-		SubscriptionList eventSubList;
-		eventSubList.emplace_back(newSubscription);
-		m_subscriptionListByEventName[eventName] = eventSubList;
-	}
-	else {
-		SubscriptionList& eventSubList = iter->second;
-		for (int subIndex = 0; subIndex < eventSubList.size(); subIndex++) {
-			if (eventSubList[subIndex]->IsSameFunction(&functionPtr)) {
-				ThrowError("THERE WAS AN ATTEMPT TO DOUBLE SUBSCRIBE A FUNCTION TO AN EVENT");
-			}
+	RegisteredEvent& registeredEvent = *m_registeredEvents[InternEventName(eventName).GetIndex()];
+	SubscriptionList const* eventSubList = registeredEvent.m_subscriptions.load(std::memory_order_relaxed);
+	SubscriptionList* newSubList = (eventSubList) ? new SubscriptionList(*eventSubList) : new SubscriptionList();
+	for (int subIndex = 0; subIndex < newSubList->size(); subIndex++) {
+		if ((*newSubList)[subIndex]->IsSameFunction(functionPtr)) {
+			ThrowError("THERE WAS AN ATTEMPT TO DOUBLE SUBSCRIBE A FUNCTION TO AN EVENT");
 		}
-		eventSubList.emplace_back(newSubscription);
 	}
+	newSubList->emplace_back(newSubscription);
+	PublishSubscriptions(registeredEvent, newSubList);
 
 	m_subsListMutex.unlock();
 }
 
-void EventSystem::UnsubscribeEventCallbackFunction(std::string const& eventName, EventCallbackFunction functionPtr)
+void EventSystem::RemoveSubscription(std::string const& eventName, void* objectInstance, void* functionPtr)
 {
 	m_subsListMutex.lock();
 
-	std::map<std::string, SubscriptionList>::iterator iter = m_subscriptionListByEventName.find(eventName);
-	if (iter == m_subscriptionListByEventName.end()) {
+	auto iter = m_eventIdsByName.find(eventName);
+	if (iter == m_eventIdsByName.end()) {
 		m_subsListMutex.unlock();
 		return;
 	}
-	else {
-		SubscriptionList& eventSubList = iter->second;
-		for (int subIndex = 0; subIndex < eventSubList.size(); subIndex++) {
-			if (eventSubList[subIndex]->IsSameFunction(&functionPtr)) {
-				delete eventSubList[subIndex];
-				eventSubList.erase(eventSubList.begin() + subIndex);
-				m_subsListMutex.unlock();
-				return;
-			}
+
+	RegisteredEvent& registeredEvent = *m_registeredEvents[iter->second.GetIndex()];
+	SubscriptionList const* eventSubList = registeredEvent.m_subscriptions.load(std::memory_order_relaxed);
+	bool wasRemoved = false;
+	for (int subIndex = 0; eventSubList && (subIndex < eventSubList->size()); subIndex++) {
+		EventSubscription* eventSub = (*eventSubList)[subIndex];
+		if (objectInstance && !eventSub->BelongsToObject(objectInstance)) continue;
+
+		if (eventSub->IsSameFunction(functionPtr)) {
+			SubscriptionList* newSubList = new SubscriptionList(*eventSubList);
+			newSubList->erase(newSubList->begin() + subIndex);
+			PublishSubscriptions(registeredEvent, newSubList);
+			RetireSubscription(eventSub);
+			wasRemoved = true;
+			break;
 		}
 	}
 
 	m_subsListMutex.unlock();
+
+	// The object may be deleted as soon as this returns, so nobody can still be inside its method
+	if (objectInstance && wasRemoved) {
+		WaitForOtherReaders();
+	}
 }
 
-bool EventSystem::FireEvent(std::string const& eventName, EventArgs& args)
+void EventSystem::RemoveObjectSubscriptions(void* objectInstance, void* functionPtr)
 {
-	SubscriptionList const* eventSubList = nullptr;
-
 	m_subsListMutex.lock();
 
-	for (std::map<std::string, SubscriptionList>::const_iterator iter = m_subscriptionListByEventName.begin(); iter != m_subscriptionListByEventName.end(); iter++) {
-		if (!_stricmp(iter->first.c_str(), eventName.c_str())) { // Strings without case sensitivity. 0 == strings are equal
-			eventSubList = &iter->second;
-			break;
+	bool wasRemoved = false;
+	int amountOfRegisteredEvents = m_amountOfRegisteredEvents.load();
+	for (int eventIndex = 0; eventIndex < amountOfRegisteredEvents; eventIndex++) {
+		RegisteredEvent& registeredEvent = *m_registeredEvents[eventIndex];
+		SubscriptionList const* eventSubList = registeredEvent.m_subscriptions.load(std::memory_order_relaxed);
+		if (!eventSubList) continue;
+
+		// Only copied once something actually goes, most events have nothing from this object
+		SubscriptionList* newSubList = nullptr;
+		for (int subIndex = 0; subIndex < eventSubList->size(); subIndex++) {
+			EventSubscription* eventSub = (*eventSubList)[subIndex];
+			bool isRemoved = eventSub->BelongsToObject(objectInstance) && (!functionPtr || eventSub->IsSameFunction(functionPtr));
+			if (isRemoved && !newSubList) {
+				newSubList = new SubscriptionList(eventSubList->begin(), eventSubList->begin() + subIndex);
+			}
+
+			if (isRemoved) {
+				RetireSubscription(eventSub);
+				wasRemoved = true;
+			}
+			else if (newSubList) {
+				newSubList->push_back(eventSub);
+			}
+		}
+
+		if (newSubList) {
+			PublishSubscriptions(registeredEvent, newSubList);
 		}
 	}
 
 	m_subsListMutex.unlock();
 
-	if (!eventSubList) {
-		return false;
+	if (wasRemoved) {
+		WaitForOtherReaders();
 	}
-	else {
+}
 
-		for (int subIndex = 0; subIndex < eventSubList->size(); subIndex++) {
-				bool wasConsumed = eventSubList->at(subIndex)->Execute(args);
-				if (wasConsumed) return true;
+int EventSystem::BeginReadingSubscriptions() const
+{
+	int readerSlot = GetEventReaderSlot();
+	int epochParity = (int)(m_readerEpoch.load() & 1);
+	m_readerCounts[readerSlot].m_amountOfReaders[epochParity].fetch_add(1);
+	t_eventReadingDepth++;
+	return (readerSlot << 1) | epochParity;
+}
+
+void EventSystem::EndReadingSubscriptions(int readerToken) const
+{
+	t_eventReadingDepth--;
+	m_readerCounts[readerToken >> 1].m_amountOfReaders[readerToken & 1].fetch_sub(1, std::memory_order_release);
+}
+
+void EventSystem::WaitForOtherReaders() const
+{
+	// Inside a callback this thread is a reader too, and two threads unsubscribing from callbacks would wait on each other forever
+	if (t_eventReadingDepth > 0) return;
+
+	// A thread that could still be running a removed subscription loaded its snapshot before the removal was published, and it stays
+	// counted until it's done. Once a count reaches 0 all of those are gone, readers counted after that load the new snapshot.
+	// New readers can keep a count above 0, but each slot is usually a single thread, so it drops between fires
+	for (int readerSlot = 0; readerSlot < EVENT_READER_SLOTS; readerSlot++) {
+		for (int epochParity = 0; epochParity < 2; epochParity++) {
+			while (m_readerCounts[readerSlot].m_amountOfReaders[epochParity].load() != 0) {
+				std::this_thread::yield(); // Only as long as the callbacks already running on other threads
+			}
 		}
 	}
+}
+
+void EventSystem::PublishSubscriptions(RegisteredEvent& registeredEvent, SubscriptionList const* newSubscriptions)
+{
+	if (newSubscriptions && newSubscriptions->empty()) {
+		delete newSubscriptions;
+		newSubscriptions = nullptr;
+	}
 
-	return true;
+	SubscriptionList const* oldSubscriptions = registeredEvent.m_subscriptions.exchange(newSubscriptions);
+	if (oldSubscriptions) {
+		RetiredSubscriptions retiredSubscriptions;
+		retiredSubscriptions.m_retiredEpoch = m_readerEpoch.load();
+		retiredSubscriptions.m_subscriptionList = oldSubscriptions;
+		m_retiredSubscriptions.push_back(retiredSubscriptions);
+	}
+
+	ReclaimRetiredSubscriptions();
 }
 
-bool EventSystem::FireEvent(std::string const& eventName)
+void EventSystem::RetireSubscription(EventSubscription* subscription)
 {
-	SubscriptionList const* eventSubList = nullptr;
+	RetiredSubscriptions retiredSubscriptions;
+	retiredSubscriptions.m_retiredEpoch = m_readerEpoch.load();
+	retiredSubscriptions.m_subscription = subscription;
+	m_retiredSubscriptions.push_back(retiredSubscriptions);
+}
 
-	m_subsListMutex.lock();
+bool EventSystem::HasReaders(int epochParity) const
+{
+	for (int readerSlot = 0; readerSlot < EVENT_READER_SLOTS; readerSlot++) {
+		if (m_readerCounts[readerSlot].m_amountOfReaders[epochParity].load() != 0) return true;
+	}
+	return false;
+}
 
-	for (std::map<std::string, SubscriptionList>::const_iterator iter = m_subscriptionListByEventName.begin(); iter != m_subscriptionListByEventName.end(); iter++) {
-		if (!_stricmp(iter->first.c_str(), eventName.c_str())) {
-			eventSubList = &iter->second;
-			break;
-		}
+void EventSystem::ReclaimRetiredSubscriptions()
+{
+	// The epoch only moves on once the readers of the epoch before the current one are gone, so readers only ever count in
+	// the current epoch or the one before. Whatever was retired in epoch E can't be held by anyone once the epoch reaches E + 2.
+	// A reader that counts itself in a parity after it was checked only loads snapshots published before the check, so it's safe to ignore
+	for (int advanceIndex = 0; advanceIndex < 2; advanceIndex++) {
+		uint64_t readerEpoch = m_readerEpoch.load();
+		if (HasReaders((int)((readerEpoch + 1) & 1))) break;
+		m_readerEpoch.store(readerEpoch + 1);
 	}
 
-	m_subsListMutex.unlock();
+	uint64_t readerEpoch = m_readerEpoch.load();
+	int amountOfReclaimed = 0;
+	while ((amountOfReclaimed < m_retiredSubscriptions.size()) && (m_retiredSubscriptions[amountOfReclaimed].m_retiredEpoch + 2 <= readerEpoch)) {
+		delete m_retiredSubscriptions[amountOfReclaimed].m_subscriptionList;
+		delete m_retiredSubscriptions[amountOfReclaimed].m_subscription;
+		amountOfReclaimed++;
+	}
+	m_retiredSubscriptions.erase(m_retiredSubscriptions.begin(), m_retiredSubscriptions.begin() + amountOfReclaimed);
+}
+
+void EventSystem::SubscribeEventCallbackFunction(std::string const& eventName, EventCallbackFunction functionPtr)
+{
+	EventFuncSubscription* newSubscription = new EventFuncSubscription(functionPtr);
+	AddSubscription(eventName, newSubscription, &functionPtr);
+}
+
+void EventSystem::UnsubscribeEventCallbackFunction(std::string const& eventName, EventCallbackFunction functionPtr)
+{
+	RemoveSubscription(eventName, nullptr, &functionPtr);
+}
+
+bool EventSystem::FireEvent(std::string const& eventName, EventArgs& args)
+{
+	return FireEvent(FindEventId(eventName), args);
+}
+
+bool EventSystem::FireEvent(std::string const& eventName)
+{
+	return FireEvent(FindEventId(eventName));
+}
 
+bool EventSystem::FireEvent(EventId eventId, EventArgs& args)
+{
+	RegisteredEvent const* registeredEvent = GetRegisteredEvent(eventId);
+	if (!registeredEvent) return false;
+
+	// Safe against subscribing and unsubscribing on other threads (or from the callbacks themselves), the snapshot stays alive until reading ends
+	int readerToken = BeginReadingSubscriptions();
+	SubscriptionList const* eventSubList = registeredEvent->m_subscriptions.load();
 	if (!eventSubList) {
+		EndReadingSubscriptions(readerToken);
+		if (m_profiler) m_profiler->RecordUnhandledFire(eventId);
 		return false;
 	}
-	else {
-		EventArgs emptyArgs;
-		for (int subIndex = 0; subIndex < eventSubList->size(); subIndex++) {
-			bool wasConsumed = eventSubList->at(subIndex)->Execute(emptyArgs);
-			if (wasConsumed) return true;
-		}
+
+	if (m_profiler) {
+		FireProfiledEvent(eventId, *eventSubList, args);
+		EndReadingSubscriptions(readerToken);
+		return true;
+	}
+
+	for (int subIndex = 0; subIndex < eventSubList->size(); subIndex++) {
+		bool wasConsumed = (*eventSubList)[subIndex]->Execute(args);
+		if (wasConsumed) break;
 	}
 
+	EndReadingSubscriptions(readerToken);
 	return true;
 }
 
+bool EventSystem::FireProfiledEvent(EventId eventId, SubscriptionList const& eventSubList, EventArgs& args)
+{
+	// Same loop as FireEvent, timing every handler. Nested fires count in their handler's time too
+	int threadIndex = EventProfiler::GetCurrentThreadIndex();
+	double fireStartTime = GetCurrentTimeSeconds();
+	bool wasConsumed = false;
+
+	for (int subIndex = 0; subIndex < eventSubList.size(); subIndex++) {
+		EventSubscription const* subscription = eventSubList[subIndex];
+
+		double handlerStartTime = GetCurrentTimeSeconds();
+		wasConsumed = subscription->Execute(args);
+		double handlerEndTime = GetCurrentTimeSeconds();
+
+		subscription->m_profileCounters.Record((int64_t)((handlerEndTime - handlerStartTime) * 1e9), wasConsumed);
+		m_profiler->RecordTimelineEvent({ eventId.GetIndex(), subIndex, threadIndex, handlerStartTime, handlerEndTime, wasConsumed });
+		if (wasConsumed) break;
+	}
+
+	double fireEndTime = GetCurrentTimeSeconds();
+	m_profiler->GetEventCounters(eventId).Record((int64_t)((fireEndTime - fireStartTime) * 1e9), wasConsumed);
+	m_profiler->RecordTimelineEvent({ eventId.GetIndex(), -1, threadIndex, fireStartTime, fireEndTime, wasConsumed });
+
+	return wasConsumed;
+}
+
+bool EventSystem::FireEvent(EventId eventId)
+{
+	EventArgs emptyArgs;
+	return FireEvent(eventId, emptyArgs);
+}
+
+
+void EventSystem::PostEvent(EventId eventId, EventArgs const& args, bool coalesce)
+{
+	if (!GetRegisteredEvent(eventId)) return;
+
+	PostedEvent* postedEvent = new PostedEvent();
+	postedEvent->m_eventId = eventId;
+	postedEvent->m_args = args;
+	postedEvent->m_coalesce = coalesce;
+	postedEvent->m_postIndex = m_amountOfPostedEvents.fetch_add(1, std::memory_order_relaxed);
+
+	PostedEventQueue& postedEventQueue = GetPostedEventQueue();
+	PostedEvent* queueHead = postedEventQueue.m_head.load(std::memory_order_relaxed);
+	do {
+		postedEvent->m_nextPostedEvent = queueHead;
+	} while (!postedEventQueue.m_head.compare_exchange_weak(queueHead, postedEvent, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void EventSystem::PostEvent(EventId eventId, bool coalesce)
+{
+	EventArgs emptyArgs;
+	PostEvent(eventId, emptyArgs, coalesce);
+}
+
+void EventSystem::PostEvent(std::string const& eventName, EventArgs const& args, bool coalesce)
+{
+	PostEvent(RegisterEvent(eventName), args, coalesce);
+}
+
+int EventSystem::DispatchQueuedEvents()
+{
+	// Callbacks dispatching again would fire newer events before older ones
+	if (m_isDispatchingQueuedEvents.exchange(true)) return 0;
+
+	// Events posted by the callbacks below wait for the next dispatch
+	m_dispatchedEvents.clear();
+	m_subsListMutex.lock(); // lock
+	for (int queueIndex = 0; queueIndex < m_postedEventQueues.size(); queueIndex++) {
+		PostedEvent* postedEvent = m_postedEventQueues[queueIndex]->m_head.exchange(nullptr, std::memory_order_acquire);
+		for (; postedEvent; postedEvent = postedEvent->m_nextPostedEvent) {
+			m_dispatchedEvents.push_back(postedEvent);
+		}
+	}
+	m_subsListMutex.unlock(); // unlock
+
+	if (m_dispatchedEvents.empty()) {
+		m_isDispatchingQueuedEvents = false;
+		return 0;
+	}
+
+	std::sort(m_dispatchedEvents.begin(), m_dispatchedEvents.end(), [](PostedEvent const* firstEvent, PostedEvent const* secondEvent) {
+		return firstEvent->m_postIndex < secondEvent->m_postIndex;
+	});
+
+	// Newest first, so the latest coalesced post of each event is the one that stays
+	std::vector<bool> isEventCoalesced(m_amountOfRegisteredEvents.load(), false);
+	for (int eventIndex = (int)m_dispatchedEvents.size() - 1; eventIndex >= 0; eventIndex--) {
+		PostedEvent* postedEvent = m_dispatchedEvents[eventIndex];
+		if (!postedEvent->m_coalesce) continue;
+
+		int registeredEventIndex = postedEvent->m_eventId.GetIndex();
+		if (isEventCoalesced[registeredEventIndex]) {
+			delete postedEvent;
+			m_dispatchedEvents[eventIndex] = nullptr;
+		}
+		else {
+			isEventCoalesced[registeredEventIndex] = true;
+		}
+	}
+
+	int amountOfFiredEvents = 0;
+	for (int eventIndex = 0; eventIndex < m_dispatchedEvents.size(); eventIndex++) {
+		PostedEvent* postedEvent = m_dispatchedEvents[eventIndex];
+		if (!postedEvent) continue;
+
+		FireEvent(postedEvent->m_eventId, postedEvent->m_args);
+		amountOfFiredEvents++;
+		delete postedEvent;
+	}
+	m_dispatchedEvents.clear();
+
+	m_isDispatchingQueuedEvents = false;
+	return amountOfFiredEvents;
+}
+
+PostedEventQueue& EventSystem::GetPostedEventQueue()
+{
+	if (t_postedEventQueueOwnerIndex != m_eventSystemIndex) {
+		PostedEventQueue* postedEventQueue = new PostedEventQueue();
+
+		m_subsListMutex.lock(); // lock
+		m_postedEventQueues.push_back(postedEventQueue);
+		m_subsListMutex.unlock(); // unlock
+
+		t_postedEventQueue = postedEventQueue;
+		t_postedEventQueueOwnerIndex = m_eventSystemIndex;
+	}
+
+	return *t_postedEventQueue;
+}
+
+void EventSystem::DiscardPostedEvents()
+{
+	m_subsListMutex.lock(); // lock
+	for (int queueIndex = 0; queueIndex < m_postedEventQueues.size(); queueIndex++) {
+		PostedEvent* postedEvent = m_postedEventQueues[queueIndex]->m_head.exchange(nullptr, std::memory_order_acquire);
+		while (postedEvent) {
+			PostedEvent* nextPostedEvent = postedEvent->m_nextPostedEvent;
+			delete postedEvent;
+			postedEvent = nextPostedEvent;
+		}
+	}
+	m_subsListMutex.unlock(); // unlock
+}
 
 void EventSystem::ThrowError(std::string const& errorMsg) const
 {
@@ -215,4 +735,43 @@ bool FireEvent(std::string const& eventName)
 	return false;
 }
 
+EventId RegisterEvent(std::string const& eventName)
+{
+	if (g_theEventSystem) {
+		return g_theEventSystem->RegisterEvent(eventName);
+	}
+
+	return EventId();
+}
+
+bool FireEvent(EventId eventId, EventArgs& args)
+{
+	if (g_theEventSystem) {
+		return g_theEventSystem->FireEvent(eventId, args);
+	}
+
+	return false;
+}
+
+bool FireEvent(EventId eventId)
+{
+	if (g_theEventSystem) {
+		return g_theEventSystem->FireEvent(eventId);
+	}
+
+	return false;
+}
+
+void PostEvent(EventId eventId, EventArgs const& args, bool coalesce)
+{
+	if (g_theEventSystem) {
+		g_theEventSystem->PostEvent(eventId, args, coalesce);
+	}
+}
 
+void PostEvent(std::string const& eventName, EventArgs const& args, bool coalesce)
+{
+	if (g_theEventSystem) {
+		g_theEventSystem->PostEvent(eventName, args, coalesce);
+	}
+}
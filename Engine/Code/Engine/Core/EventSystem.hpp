@@ -1,14 +1,28 @@
 #pragma once
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <atomic>
 #include <string>
 #include <mutex>
+#include <typeinfo>
+#include "Engine/Core/StringUtils.hpp"
 
 class NamedProperties;
 
 typedef NamedProperties EventArgs;
 typedef bool (*EventCallbackFunction)(EventArgs& args);
 
+// Only updated while the EventSystem is profiling
+struct EventProfileCounters {
+	std::atomic<int> m_amountOfCalls = 0;
+	std::atomic<int> m_amountOfConsumes = 0; // Returned true, so nothing after it ran
+	std::atomic<int64_t> m_totalNanoseconds = 0;
+	std::atomic<int64_t> m_maxNanoseconds = 0;
+
+	void Record(int64_t nanoseconds, bool wasConsumed);
+	void Reset();
+};
+
 class EventSubscription {
 public:
 	EventSubscription() = default;
@@ -17,6 +31,9 @@ public:
 	virtual bool IsSameFunction(void* otherFunction) const = 0;
 	virtual bool Execute(EventArgs&) const = 0;
 	virtual bool BelongsToObject(void* object) const { object; return false; }
+	virtual std::string GetName() const = 0; // For profiling reports
+
+	mutable EventProfileCounters m_profileCounters;
 };
 
 class EventFuncSubscription : public EventSubscription {
@@ -25,6 +42,7 @@ public:
 	EventCallbackFunction m_callbackFunction;
 	virtual bool Execute(EventArgs& eventArgs) const override;
 	virtual bool IsSameFunction(void* otherFunction) const override;
+	virtual std::string GetName() const override;
 };
 
 template<typename T_ObjectType>
@@ -49,21 +67,73 @@ public:
 		return m_objectInstance == object;
 	}
 
+	virtual std::string GetName() const override {
+		return std::string(typeid(T_ObjectType).name()) + " method";
+	}
+
 
 private:
 	T_ObjectType* m_objectInstance = nullptr;
 	MethodType m_method = nullptr;
 };
 
-struct EventSystemConfig {
+class EventSystem;
+
+// Interned event name. Stays valid for the EventSystem's whole lifetime, firing through it skips the name lookup
+class EventId {
+public:
+	EventId() = default;
+	explicit EventId(int index) : m_index(index) {}
+
+	int GetIndex() const { return m_index; }
+	bool IsValid() const { return m_index >= 0; }
+	bool operator==(EventId const& otherId) const { return m_index == otherId.m_index; }
+	bool operator!=(EventId const& otherId) const { return m_index != otherId.m_index; }
 
+private:
+	int m_index = -1;
 };
 
+struct EventSystemConfig {
+	int m_maxAmountOfEvents = 4096; // Distinct event names, ids index a fixed table so firing by id never locks
+	bool m_enableProfiling = false; // Counts and times every fire and every handler, see EventProfiler
+	int m_maxProfiledFires = 65536; // Kept for the trace export, fires past it only count in the stats
+};
 
 extern EventSystem* g_theEventSystem;
 
 typedef std::vector<EventSubscription*> SubscriptionList;
 
+constexpr int EVENT_READER_SLOTS = 64; // Threads firing events spread over these, so readers almost never share a counter
+
+// Subscriber lists are copied on write: firing reads whichever snapshot is current without locking, and changes publish a new one.
+// Old snapshots (and removed subscriptions) are only deleted once every thread that could still be iterating them is done
+struct RegisteredEvent {
+	std::string m_name; // As it was first registered
+	std::atomic<SubscriptionList const*> m_subscriptions = nullptr; // Never modified once published, nullptr when nobody is subscribed
+};
+
+// Reader slots get a cache line each, which pads them and every class holding them
+#pragma warning(push)
+#pragma warning(disable : 4324) // Structure was padded due to alignment specifier
+
+// Firing threads count themselves in the current epoch's parity, one cache line per slot
+struct alignas(64) EventReaderCounts {
+	std::atomic<int> m_amountOfReaders[2] = { 0, 0 };
+};
+
+// Left behind by a change to a subscriber list, deleted two epochs later
+struct RetiredSubscriptions {
+	uint64_t m_retiredEpoch = 0;
+	SubscriptionList const* m_subscriptionList = nullptr;
+	EventSubscription* m_subscription = nullptr;
+};
+
+struct PostedEvent;
+struct PostedEventQueue;
+struct EventProfileStats;
+class EventProfiler;
+
 class EventSystem {
 public:
 	EventSystem(EventSystemConfig const& config);
@@ -74,9 +144,20 @@ public:
 	void EndFrame();
 
 	void GetRegisteredEventNames(std::vector< std::string >& outNames) const;
+	int GetAmountOfRetiredSubscriptions() const; // Snapshots and subscriptions still waiting on firing threads
+	EventProfiler* GetProfiler() const { return m_profiler; } // nullptr unless the config enables profiling
+	void GetEventProfileStats(std::vector<EventProfileStats>& out_eventStats) const; // Every event fired since the last reset, handlers as currently subscribed
+	void ResetEventProfile();
+
+	EventId RegisterEvent(std::string const& eventName); // Same id for every capitalization of the name, registering again just returns it
+	EventId FindEventId(std::string const& eventName) const; // Invalid if the name was never registered nor subscribed to
+	std::string const& GetEventName(EventId eventId) const;
 
 	template<typename T_ObjectType, typename MethodType>
 	inline void SubscribeEventCallbackFunction(std::string const& eventName, T_ObjectType* objectInstance, MethodType functionPtr);
+	// Unsubscribing an object's methods waits until no other thread is still running them, so the object can be deleted right after.
+	// Callbacks running on other threads must not wait on the unsubscribing thread. Unsubscribing from inside a callback can't wait
+	// (two threads doing it would wait on each other), so objects deleted from inside callbacks must only be fired on that same thread
 	template<typename T_ObjectType, typename MethodType>
 	inline void UnsubscribeEventCallbackFunction(std::string const& eventName, T_ObjectType* objectInstance, MethodType functionPtr);
 	template<typename T_ObjectType, typename MethodType> // Unsubscribe specific object's methods from all events
@@ -89,117 +170,81 @@ public:
 
 	bool FireEvent(std::string const& eventName, EventArgs& args);
 	bool FireEvent(std::string const& eventName);
+	bool FireEvent(EventId eventId, EventArgs& args);
+	bool FireEvent(EventId eventId);
+
+	// Safe from any thread (jobs included): the args are copied into the posting thread's queue, and the event is fired later on the
+	// thread calling DispatchQueuedEvents, in posting order. Coalesced posts only fire the latest one of each event per dispatch
+	void PostEvent(EventId eventId, EventArgs const& args, bool coalesce = false);
+	void PostEvent(EventId eventId, bool coalesce = false);
+	void PostEvent(std::string const& eventName, EventArgs const& args, bool coalesce = false);
+	int DispatchQueuedEvents(); // Main thread only, BeginFrame and EndFrame already do it. Returns how many events were fired
 	void ThrowError(std::string const& errorMsg) const;
 
+protected:
+	int BeginReadingSubscriptions() const; // Returns what EndReadingSubscriptions needs, nests fine
+	void EndReadingSubscriptions(int readerToken) const;
+	bool FireProfiledEvent(EventId eventId, SubscriptionList const& eventSubList, EventArgs& args);
+	void PublishSubscriptions(RegisteredEvent& registeredEvent, SubscriptionList const* newSubscriptions); // Mutex has to be held
+	void RetireSubscription(EventSubscription* subscription); // Mutex has to be held
+	bool HasReaders(int epochParity) const;
+	void WaitForOtherReaders() const; // Mutex must not be held, callbacks on other threads may need it to finish
+	PostedEventQueue& GetPostedEventQueue(); // The calling thread's, created on its first post
+	void DiscardPostedEvents();
+	void ReclaimRetiredSubscriptions(); // Mutex has to be held, never waits on readers
+	EventId InternEventName(std::string const& eventName); // Mutex has to be held
+	RegisteredEvent* GetRegisteredEvent(EventId eventId) const;
+	void AddSubscription(std::string const& eventName, EventSubscription* newSubscription, void* functionPtr);
+	void RemoveSubscription(std::string const& eventName, void* objectInstance, void* functionPtr); // nullptr object for plain functions
+	void RemoveObjectSubscriptions(void* objectInstance, void* functionPtr); // From every event, nullptr function for all of the object's methods
+
 protected:
 	EventSystemConfig m_config;
 
 	mutable std::mutex m_subsListMutex;
-	std::map<std::string, SubscriptionList> m_subscriptionListByEventName;
+	std::unordered_map<std::string, EventId, CaseInsensitiveStringHash, CaseInsensitiveStringEqual> m_eventIdsByName; // Event names are case insensitive
+	RegisteredEvent** m_registeredEvents = nullptr; // Indexed by EventId. Entries are only ever appended, and deleted with the EventSystem
+	std::atomic<int> m_amountOfRegisteredEvents = 0;
+
+	mutable EventReaderCounts m_readerCounts[EVENT_READER_SLOTS];
+	std::atomic<uint64_t> m_readerEpoch = 0;
+	std::vector<RetiredSubscriptions> m_retiredSubscriptions; // Oldest first, guarded by the mutex
+
+	int m_eventSystemIndex = 0; // Tells threads whose queue pointer belongs to an older EventSystem apart
+	std::vector<PostedEventQueue*> m_postedEventQueues; // One per thread that ever posted, guarded by the mutex
+	std::atomic<uint64_t> m_amountOfPostedEvents = 0;
+	std::atomic<bool> m_isDispatchingQueuedEvents = false;
+	std::vector<PostedEvent*> m_dispatchedEvents; // Reused by every dispatch
+
+	EventProfiler* m_profiler = nullptr;
 };
 
+#pragma warning(pop)
+
 template<typename T_ObjectType, typename MethodType>
 void EventSystem::SubscribeEventCallbackFunction(std::string const& eventName, T_ObjectType* objectInstance, MethodType functionPtr)
 {
 	EventMethodSubscription<T_ObjectType>* newSubscription = new EventMethodSubscription<T_ObjectType>(objectInstance, functionPtr);
-
-	m_subsListMutex.lock();
-
-	std::map<std::string, SubscriptionList>::iterator iter = m_subscriptionListByEventName.find(eventName);
-	if (iter == m_subscriptionListByEventName.end()) {
-		SubscriptionList eventSubList;
-		eventSubList.push_back(newSubscription);
-		m_subscriptionListByEventName[eventName] = eventSubList;
-	}
-	else {
-		SubscriptionList& eventSubList = iter->second;
-		for (int subIndex = 0; subIndex < eventSubList.size(); subIndex++) {
-			if (eventSubList[subIndex]->IsSameFunction(&functionPtr)) {
-				ThrowError("THERE WAS AN ATTEMPT TO DOUBLE SUBSCRIBE A FUNCTION TO AN EVENT");
-			}
-		}
-		eventSubList.push_back(newSubscription);
-	}
-
-	m_subsListMutex.unlock();
+	AddSubscription(eventName, newSubscription, &functionPtr);
 }
 
 template<typename T_ObjectType, typename MethodType>
 void EventSystem::UnsubscribeEventCallbackFunction(std::string const& eventName, T_ObjectType* objectInstance, MethodType functionPtr)
 {
-	m_subsListMutex.lock();
-
-	std::map<std::string, SubscriptionList>::iterator iter = m_subscriptionListByEventName.find(eventName);
-	if (iter == m_subscriptionListByEventName.end()) {
-		m_subsListMutex.unlock();
-		return;
-	}
-	else {
-		SubscriptionList& eventSubList = iter->second;
-		for (int subIndex = 0; subIndex < eventSubList.size(); subIndex++) {
-			EventSubscription*& eventSub = eventSubList[subIndex];
-			if (eventSub->BelongsToObject(objectInstance)) {
-				if (eventSubList[subIndex]->IsSameFunction(&functionPtr)) {
-					delete eventSubList[subIndex];
-					eventSubList.erase(eventSubList.begin() + subIndex);
-					m_subsListMutex.unlock();
-					return;
-				}
-			}
-		}
-	}
-
-	m_subsListMutex.unlock();
+	RemoveSubscription(eventName, objectInstance, &functionPtr);
 }
 
 
 template<typename T_ObjectType, typename MethodType>
 void EventSystem::UnsubscribeAllEventCallbackFunctions(T_ObjectType* objectInstance, MethodType functionPtr)
 {
-	for (auto it = m_subscriptionListByEventName.begin(); it != m_subscriptionListByEventName.end(); it++) {
-		SubscriptionList& subList = it->second;
-		if (subList.size() == 0) continue;
-		m_subsListMutex.lock();
-
-		for (auto subListIt = subList.begin(); subListIt != subList.end();) {
-			EventSubscription*& eventSub = *subListIt;
-			if (eventSub->BelongsToObject(objectInstance)) {
-				if (eventSub->IsSameFunction(&functionPtr)) {
-					subListIt = subList.erase(subListIt);
-				}
-				else {
-					subListIt++;
-				}
-			}
-			else {
-				subListIt++;
-			}
-		}
-
-		m_subsListMutex.unlock();
-	}
+	RemoveObjectSubscriptions(objectInstance, &functionPtr);
 }
 
 template<typename T_ObjectType>
 void EventSystem::UnsubscribeAllEventCallbackFunctions(T_ObjectType* objectInstance)
 {
-	for (auto it = m_subscriptionListByEventName.begin(); it != m_subscriptionListByEventName.end(); it++) {
-		SubscriptionList& subList = it->second;
-		if (subList.size() == 0) continue;
-		m_subsListMutex.lock();
-
-		for (auto subListIt = subList.begin(); subListIt != subList.end();) {
-			EventSubscription*& eventSub = *subListIt;
-			if (eventSub->BelongsToObject(objectInstance)) {
-				subListIt = subList.erase(subListIt);
-			}
-			else {
-				subListIt++;
-			}
-		}
-
-		m_subsListMutex.unlock();
-	}
+	RemoveObjectSubscriptions(objectInstance, nullptr);
 }
 
 template<typename T_ObjectType, typename MethodType>
@@ -238,6 +283,11 @@ void SubscribeEventCallbackFunction(std::string const& eventName, EventCallbackF
 void UnsubscribeEventCallbackFunction(std::string const& eventName, EventCallbackFunction functionPtr);
 bool FireEvent(std::string const& eventName, EventArgs& args);
 bool FireEvent(std::string const& eventName);
+EventId RegisterEvent(std::string const& eventName); // Invalid without an EventSystem
+bool FireEvent(EventId eventId, EventArgs& args);
+bool FireEvent(EventId eventId);
+void PostEvent(EventId eventId, EventArgs const& args, bool coalesce = false);
+void PostEvent(std::string const& eventName, EventArgs const& args, bool coalesce = false);
 
 
 class EventRecipient {
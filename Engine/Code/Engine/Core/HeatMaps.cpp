@@ -1,6 +1,9 @@
 #include "Engine/Core/HeatMaps.hpp"
+#include "Engine/Core/ParallelAlgorithms.hpp"
 #include "Engine/Math/RandomNumberGenerator.hpp"
 
+constexpr int HEAT_MAP_SWEEP_GRAIN_SIZE = 4096; // Tiles per job, smaller maps are swept on the calling thread
+
 
 TileHeatMap::TileHeatMap(IntVec2 const& dimensions):
 	m_dimensions(dimensions)
@@ -12,9 +15,11 @@ TileHeatMap::TileHeatMap(IntVec2 const& dimensions):
 
 void TileHeatMap::SetAllValues(float newValue)
 {
-	for (int valuesIndex = 0; valuesIndex < m_values.capacity(); valuesIndex++) {
-		m_values[valuesIndex] = newValue;
-	}
+	ParallelForRange(0, (int)m_values.size(), HEAT_MAP_SWEEP_GRAIN_SIZE, [this, newValue](int rangeBegin, int rangeEnd) {
+		for (int valuesIndex = rangeBegin; valuesIndex < rangeEnd; valuesIndex++) {
+			m_values[valuesIndex] = newValue;
+		}
+	});
 }
 
 float TileHeatMap::GetValue(int index) const
@@ -116,13 +121,21 @@ IntVec2 TileHeatMap::GetCoordsForNextHighestValue(IntVec2 const& coords) const
 
 float TileHeatMap::GetMaxValue(float maxValueToLookUnder) const
 {
-	float maxValue = -1.0f;
-	for (int valueIndex = 0; valueIndex < m_values.size(); valueIndex++) {
-		if (m_values[valueIndex] > maxValue && m_values[valueIndex] < maxValueToLookUnder) {
-			maxValue = m_values[valueIndex];
+	auto getRangeMaxValue = [this, maxValueToLookUnder](int rangeBegin, int rangeEnd) {
+		float maxValue = -1.0f;
+		for (int valueIndex = rangeBegin; valueIndex < rangeEnd; valueIndex++) {
+			if (m_values[valueIndex] > maxValue && m_values[valueIndex] < maxValueToLookUnder) {
+				maxValue = m_values[valueIndex];
+			}
 		}
-	}
-	return maxValue;
+		return maxValue;
+	};
+
+	auto getLargerValue = [](float firstValue, float secondValue) {
+		return (firstValue > secondValue) ? firstValue : secondValue;
+	};
+
+	return ParallelReduce(0, (int)m_values.size(), HEAT_MAP_SWEEP_GRAIN_SIZE, -1.0f, getRangeMaxValue, getLargerValue);
 }
 
 IntVec2 TileHeatMap::GetRandomValue(float valueLowerThanExclusive) const
@@ -0,0 +1,86 @@
+#include "Engine/Core/JobPool.hpp"
+
+static uint64_t MakeFreeListHead(uint64_t previousHead, uint32_t headIndexPlusOne)
+{
+	uint64_t nextTag = (previousHead >> 32) + 1;
+	return (nextTag << 32) | static_cast<uint64_t>(headIndexPlusOne);
+}
+
+JobPool::~JobPool()
+{
+	for (int chunkIndex = 0; chunkIndex < JOB_POOL_MAX_CHUNKS; chunkIndex++) {
+		delete m_chunks[chunkIndex].load();
+		m_chunks[chunkIndex] = nullptr;
+	}
+}
+
+int JobPool::Allocate()
+{
+	uint64_t head = m_freeListHead.load(std::memory_order_acquire);
+	while (true) {
+		uint32_t headIndexPlusOne = static_cast<uint32_t>(head);
+		if (headIndexPlusOne == 0) {
+			if (!Grow()) return -1;
+			head = m_freeListHead.load(std::memory_order_acquire);
+			continue;
+		}
+
+		// Another thread may take this block first, then the read is stale but the tag makes the CAS fail
+		uint32_t nextIndexPlusOne = GetNextFreeBlock(headIndexPlusOne - 1).load(std::memory_order_relaxed);
+		if (m_freeListHead.compare_exchange_weak(head, MakeFreeListHead(head, nextIndexPlusOne), std::memory_order_acq_rel, std::memory_order_acquire)) {
+			m_amountOfBlocksInUse++;
+			return static_cast<int>(headIndexPlusOne - 1);
+		}
+	}
+}
+
+void JobPool::Free(int blockIndex)
+{
+	uint32_t freedIndex = static_cast<uint32_t>(blockIndex);
+	uint64_t head = m_freeListHead.load(std::memory_order_relaxed);
+	do {
+		GetNextFreeBlock(freedIndex).store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+	} while (!m_freeListHead.compare_exchange_weak(head, MakeFreeListHead(head, freedIndex + 1), std::memory_order_release, std::memory_order_relaxed));
+
+	m_amountOfBlocksInUse--;
+}
+
+void* JobPool::GetBlock(int blockIndex) const
+{
+	Chunk* chunk = m_chunks[blockIndex / JOB_POOL_BLOCKS_PER_CHUNK].load(std::memory_order_acquire);
+	return chunk->m_blocks[blockIndex % JOB_POOL_BLOCKS_PER_CHUNK];
+}
+
+std::atomic<uint32_t>& JobPool::GetNextFreeBlock(uint32_t blockIndex) const
+{
+	Chunk* chunk = m_chunks[blockIndex / JOB_POOL_BLOCKS_PER_CHUNK].load(std::memory_order_acquire);
+	return chunk->m_nextFreeBlocks[blockIndex % JOB_POOL_BLOCKS_PER_CHUNK];
+}
+
+bool JobPool::Grow()
+{
+	std::lock_guard<std::mutex> growLock(m_growMutex);
+
+	// Someone else grew the pool (or freed blocks) while this thread was waiting for the lock
+	if (static_cast<uint32_t>(m_freeListHead.load(std::memory_order_acquire)) != 0) return true;
+
+	int chunkIndex = m_amountOfChunks.load();
+	if (chunkIndex >= JOB_POOL_MAX_CHUNKS) return false;
+
+	Chunk* newChunk = new Chunk();
+	uint32_t firstBlockIndex = static_cast<uint32_t>(chunkIndex * JOB_POOL_BLOCKS_PER_CHUNK);
+	for (uint32_t blockOffset = 0; blockOffset < JOB_POOL_BLOCKS_PER_CHUNK - 1; blockOffset++) {
+		newChunk->m_nextFreeBlocks[blockOffset].store(firstBlockIndex + blockOffset + 2, std::memory_order_relaxed);
+	}
+
+	m_chunks[chunkIndex].store(newChunk, std::memory_order_release);
+	m_amountOfChunks++;
+
+	// Splice the whole chunk in front of whatever got freed in the meantime
+	uint64_t head = m_freeListHead.load(std::memory_order_relaxed);
+	do {
+		newChunk->m_nextFreeBlocks[JOB_POOL_BLOCKS_PER_CHUNK - 1].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+	} while (!m_freeListHead.compare_exchange_weak(head, MakeFreeListHead(head, firstBlockIndex + 1), std::memory_order_release, std::memory_order_relaxed));
+
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+constexpr int JOB_POOL_BLOCK_SIZE = 128; // Room for the Job base (72 bytes on x64) plus the captures/members of the derived job
+constexpr int JOB_POOL_MIN_CAPTURE_BYTES = 48; // Captures every pooled job is guaranteed, JobSystem.hpp checks it against sizeof(Job)
+constexpr int JOB_POOL_BLOCK_ALIGNMENT = 64; // Blocks never share a cache line
+constexpr int JOB_POOL_BLOCKS_PER_CHUNK = 256;
+constexpr int JOB_POOL_MAX_CHUNKS = 1024;
+
+// Blocks and the free list head are cache line aligned, the padding that adds is intended
+#pragma warning(push)
+#pragma warning(disable : 4324) // Structure was padded due to alignment specifier
+
+// Fixed size blocks for jobs, handed out through a lock-free free list. Chunks are only ever added, never released until
+// the pool dies, so once it has grown to the amount of jobs in flight per frame, allocating a job doesn't touch the heap
+class JobPool {
+public:
+	JobPool() = default;
+	~JobPool();
+	JobPool(JobPool const& copy) = delete;
+
+	int Allocate(); // Block index, or -1 when the pool can't grow anymore
+	void Free(int blockIndex);
+	void* GetBlock(int blockIndex) const;
+
+	void AddHeapFallbackAllocation() { m_amountOfHeapFallbacks++; }
+	int GetAmountOfHeapAllocations() const { return m_amountOfChunks.load() + m_amountOfHeapFallbacks.load(); }
+	int GetAmountOfBlocksInUse() const { return m_amountOfBlocksInUse.load(); }
+
+private:
+	struct Chunk {
+		alignas(JOB_POOL_BLOCK_ALIGNMENT) unsigned char m_blocks[JOB_POOL_BLOCKS_PER_CHUNK][JOB_POOL_BLOCK_SIZE];
+		std::atomic<uint32_t> m_nextFreeBlocks[JOB_POOL_BLOCKS_PER_CHUNK];
+	};
+
+	bool Grow();
+	std::atomic<uint32_t>& GetNextFreeBlock(uint32_t blockIndex) const;
+
+private:
+	// Low 32 bits: head block index + 1 (0 means empty), high 32 bits: tag that changes on every update, so a stale head can't win a CAS
+	alignas(64) std::atomic<uint64_t> m_freeListHead = 0;
+	alignas(64) std::atomic<Chunk*> m_chunks[JOB_POOL_MAX_CHUNKS] = {};
+	std::atomic<int> m_amountOfChunks = 0;
+	std::atomic<int> m_amountOfHeapFallbacks = 0; // Jobs that didn't fit in a block (or a full pool) and got their own allocation
+	std::atomic<int> m_amountOfBlocksInUse = 0;
+	std::mutex m_growMutex;
+};
+
+#pragma warning(pop)
@@ -0,0 +1,219 @@
+#include "Engine/Core/JobProfiler.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+
+static char const* GetJobPriorityName(JobPriority priority)
+{
+	switch (priority) {
+	case JobPriority::CRITICAL: return "Critical";
+	case JobPriority::HIGH: return "High";
+	case JobPriority::NORMAL: return "Normal";
+	case JobPriority::BACKGROUND: return "Background";
+	default: return "Unknown";
+	}
+}
+
+double JobFrameProfile::GetUtilization(int statsIndex) const
+{
+	double frameSeconds = GetFrameSeconds();
+	if (frameSeconds <= 0.0) return 0.0;
+	return m_workerStats[statsIndex].m_busySeconds / frameSeconds;
+}
+
+JobProfiler::JobProfiler(int amountOfWorkers, int maxEventsPerWorker) :
+	m_maxEventsPerWorker(maxEventsPerWorker)
+{
+	for (int timelineIndex = 0; timelineIndex <= amountOfWorkers; timelineIndex++) {
+		WorkerTimeline* timeline = new WorkerTimeline();
+		timeline->m_events.reserve(maxEventsPerWorker);
+		timeline->m_stats.m_workerId = (timelineIndex < amountOfWorkers) ? timelineIndex : -1;
+		m_timelines.push_back(timeline);
+	}
+
+	m_frameStartTime = GetCurrentTimeSeconds();
+}
+
+JobProfiler::~JobProfiler()
+{
+	for (int timelineIndex = 0; timelineIndex < m_timelines.size(); timelineIndex++) {
+		delete m_timelines[timelineIndex];
+		m_timelines[timelineIndex] = nullptr;
+	}
+}
+
+void JobProfiler::BeginFrame()
+{
+	m_frameStartTime = GetCurrentTimeSeconds();
+}
+
+void JobProfiler::EndFrame(JobSystem const& jobSystem)
+{
+	m_lastFrameProfile.m_frameIndex = m_frameIndex++;
+	m_lastFrameProfile.m_startTime = m_frameStartTime;
+	m_lastFrameProfile.m_endTime = GetCurrentTimeSeconds();
+	m_lastFrameProfile.m_events.clear();
+	m_lastFrameProfile.m_workerStats.clear();
+	m_lastFrameProfile.m_amountOfDroppedEvents = 0;
+
+	// Swapping keeps both buffers' capacity around, so capturing doesn't allocate after the first frames
+	std::vector<JobTimelineEvent> timelineEvents;
+	for (int timelineIndex = 0; timelineIndex < m_timelines.size(); timelineIndex++) {
+		WorkerTimeline& timeline = *m_timelines[timelineIndex];
+		timelineEvents.clear();
+
+		timeline.m_mutex.lock(); // lock
+		timelineEvents.swap(timeline.m_events);
+		JobWorkerStats workerStats = timeline.m_stats;
+		m_lastFrameProfile.m_amountOfDroppedEvents += timeline.m_amountOfDroppedEvents;
+
+		timeline.m_stats = JobWorkerStats();
+		timeline.m_stats.m_workerId = workerStats.m_workerId;
+		timeline.m_amountOfDroppedEvents = 0;
+		timeline.m_events.reserve(m_maxEventsPerWorker);
+		timeline.m_mutex.unlock(); // unlock
+
+		workerStats.m_logicalCoreId = jobSystem.GetWorkerLogicalCore(workerStats.m_workerId);
+		m_lastFrameProfile.m_workerStats.push_back(workerStats);
+		m_lastFrameProfile.m_events.insert(m_lastFrameProfile.m_events.end(), timelineEvents.begin(), timelineEvents.end());
+	}
+
+	std::sort(m_lastFrameProfile.m_events.begin(), m_lastFrameProfile.m_events.end(), [](JobTimelineEvent const& firstEvent, JobTimelineEvent const& secondEvent) {
+		return firstEvent.m_startTime < secondEvent.m_startTime;
+	});
+
+	m_frameStartTime = m_lastFrameProfile.m_endTime;
+}
+
+JobProfiler::WorkerTimeline& JobProfiler::GetTimeline(int workerId)
+{
+	if ((workerId < 0) || (workerId >= (int)m_timelines.size() - 1)) return *m_timelines.back();
+	return *m_timelines[workerId];
+}
+
+void JobProfiler::RecordJob(JobTimelineEvent const& timelineEvent)
+{
+	WorkerTimeline& timeline = GetTimeline(timelineEvent.m_workerId);
+
+	timeline.m_mutex.lock(); // lock
+
+	if ((int)timeline.m_events.size() < m_maxEventsPerWorker) {
+		timeline.m_events.push_back(timelineEvent);
+	}
+	else {
+		timeline.m_amountOfDroppedEvents++;
+	}
+
+	timeline.m_stats.m_amountOfExecutedJobs++;
+	timeline.m_stats.m_busySeconds += timelineEvent.GetExecutionSeconds();
+	if (timelineEvent.m_wasStolen) {
+		timeline.m_stats.m_amountOfStolenJobs++;
+	}
+
+	timeline.m_mutex.unlock(); // unlock
+}
+
+void JobProfiler::RecordParking(int workerId, double parkedSeconds)
+{
+	WorkerTimeline& timeline = GetTimeline(workerId);
+
+	timeline.m_mutex.lock(); // lock
+	timeline.m_stats.m_parkedSeconds += parkedSeconds;
+	timeline.m_mutex.unlock(); // unlock
+}
+
+void WriteChromeTrace(JobFrameProfile const& frameProfile, std::string& out_traceJson)
+{
+	// Each worker is a thread of its own in chrome://tracing (or ui.perfetto.dev), the helping threads share thread 0
+	out_traceJson = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out_traceJson += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"JobSystem\"}}";
+
+	for (int statsIndex = 0; statsIndex < frameProfile.m_workerStats.size(); statsIndex++) {
+		JobWorkerStats const& workerStats = frameProfile.m_workerStats[statsIndex];
+		int threadId = workerStats.m_workerId + 1;
+
+		std::string threadName = (workerStats.m_workerId < 0) ? "Helping threads" : Stringf("Worker %d", workerStats.m_workerId);
+		if (workerStats.m_logicalCoreId >= 0) {
+			threadName += Stringf(" (core %d)", workerStats.m_logicalCoreId);
+		}
+		threadName += Stringf(" %.0f%% busy", frameProfile.GetUtilization(statsIndex) * 100.0);
+
+		out_traceJson += Stringf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", threadId);
+		AppendJsonString(out_traceJson, threadName.c_str());
+		out_traceJson += "}}";
+		out_traceJson += Stringf(",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}", threadId, threadId);
+	}
+
+	for (int eventIndex = 0; eventIndex < frameProfile.m_events.size(); eventIndex++) {
+		JobTimelineEvent const& timelineEvent = frameProfile.m_events[eventIndex];
+		double startMicroseconds = (timelineEvent.m_startTime - frameProfile.m_startTime) * 1'000'000.0;
+		double durationMicroseconds = timelineEvent.GetExecutionSeconds() * 1'000'000.0;
+
+		out_traceJson += ",\n{\"name\":";
+		AppendJsonString(out_traceJson, timelineEvent.m_jobName ? timelineEvent.m_jobName : "Job");
+		out_traceJson += Stringf(",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", GetJobPriorityName(timelineEvent.m_priority), timelineEvent.m_workerId + 1, startMicroseconds, durationMicroseconds);
+		out_traceJson += Stringf(",\"args\":{\"queueWaitUs\":%.3f,\"jobType\":%d,\"stolen\":%s}}", timelineEvent.GetQueueWaitSeconds() * 1'000'000.0, timelineEvent.m_jobType, timelineEvent.m_wasStolen ? "true" : "false");
+	}
+
+	out_traceJson += "\n]}\n";
+}
+
+bool ExportChromeTrace(JobFrameProfile const& frameProfile, std::string const& filePath)
+{
+	std::string traceJson;
+	WriteChromeTrace(frameProfile, traceJson);
+
+	std::vector<uint8_t> fileBuffer(traceJson.begin(), traceJson.end());
+	return FileWriteFromBuffer(fileBuffer, filePath) == 0;
+}
+
+void GetJobFrameProfileReport(JobFrameProfile const& frameProfile, std::vector<std::string>& out_reportLines)
+{
+	out_reportLines.push_back(Stringf("JobSystem frame %d: %.3f ms, %d jobs (%d dropped from the timeline)", frameProfile.m_frameIndex, frameProfile.GetFrameSeconds() * 1000.0, (int)frameProfile.m_events.size(), frameProfile.m_amountOfDroppedEvents));
+
+	for (int statsIndex = 0; statsIndex < frameProfile.m_workerStats.size(); statsIndex++) {
+		JobWorkerStats const& workerStats = frameProfile.m_workerStats[statsIndex];
+		std::string workerName = (workerStats.m_workerId < 0) ? "Helping threads" : Stringf("Worker %d", workerStats.m_workerId);
+		out_reportLines.push_back(Stringf("  %-16s %5.1f%% busy  %6d jobs  %6d stolen  %8.3f ms parked", workerName.c_str(), frameProfile.GetUtilization(statsIndex) * 100.0, workerStats.m_amountOfExecutedJobs, workerStats.m_amountOfStolenJobs, workerStats.m_parkedSeconds * 1000.0));
+	}
+
+	// Queue wait percentiles tell contention (jobs sitting in queues) apart from plain lack of work (idle gaps)
+	if (!frameProfile.m_events.empty()) {
+		std::vector<double> queueWaits;
+		queueWaits.reserve(frameProfile.m_events.size());
+		for (int eventIndex = 0; eventIndex < frameProfile.m_events.size(); eventIndex++) {
+			queueWaits.push_back(frameProfile.m_events[eventIndex].GetQueueWaitSeconds());
+		}
+		std::sort(queueWaits.begin(), queueWaits.end());
+
+		double medianWait = queueWaits[queueWaits.size() / 2];
+		double p99Wait = queueWaits[(queueWaits.size() * 99) / 100];
+		out_reportLines.push_back(Stringf("  Queue wait: median %.1f us, p99 %.1f us, max %.1f us", medianWait * 1'000'000.0, p99Wait * 1'000'000.0, queueWaits.back() * 1'000'000.0));
+	}
+}
+
+bool Command_JobSystemTrace(EventArgs& args)
+{
+	JobProfiler* jobProfiler = (g_theJobSystem) ? g_theJobSystem->GetProfiler() : nullptr;
+	if (!jobProfiler) {
+		if (g_theConsole) {
+			g_theConsole->AddLine(DevConsole::ERROR_COLOR, "JobSystem profiling is off, enable it with JobSystemConfig::m_enableProfiling");
+		}
+		return false;
+	}
+
+	std::string filePath = args.GetValue("file", "Saved/JobSystemTrace.json");
+	JobFrameProfile const& frameProfile = jobProfiler->GetLastFrameProfile();
+
+	std::vector<std::string> reportLines;
+	GetJobFrameProfileReport(frameProfile, reportLines);
+	if (ExportChromeTrace(frameProfile, filePath)) {
+		reportLines.push_back(Stringf("Chrome trace written to %s", filePath.c_str()));
+	}
+
+	AddDevConsoleReportLines(reportLines);
+
+	return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+
+struct JobTimelineEvent {
+	char const* m_jobName = nullptr; // Class name of the job
+	double m_queuedTime = 0.0; // When it became ready to run (dependencies done)
+	double m_startTime = 0.0;
+	double m_endTime = 0.0;
+	int m_workerId = -1; // -1 for threads that ran it while waiting on something (main thread, ...)
+	int m_jobType = DEFAULT_JOB_ID;
+	JobPriority m_priority = JobPriority::NORMAL;
+	bool m_wasStolen = false;
+
+	double GetQueueWaitSeconds() const { return m_startTime - m_queuedTime; }
+	double GetExecutionSeconds() const { return m_endTime - m_startTime; }
+};
+
+struct JobWorkerStats {
+	int m_workerId = -1; // -1 for the helping threads
+	int m_logicalCoreId = -1;
+	int m_amountOfExecutedJobs = 0;
+	int m_amountOfStolenJobs = 0;
+	double m_busySeconds = 0.0;
+	double m_parkedSeconds = 0.0; // Counted in the frame the worker woke up in, so it can be longer than the frame itself
+};
+
+struct JobFrameProfile {
+	int m_frameIndex = -1;
+	double m_startTime = 0.0;
+	double m_endTime = 0.0;
+	std::vector<JobTimelineEvent> m_events; // Sorted by start time
+	std::vector<JobWorkerStats> m_workerStats; // One per worker, the helping threads last
+	int m_amountOfDroppedEvents = 0; // Jobs past a worker's event capacity still count in its stats
+
+	double GetFrameSeconds() const { return m_endTime - m_startTime; }
+	double GetUtilization(int statsIndex) const; // Busy time over frame time
+};
+
+// Collects what every worker did during a frame. Each worker records into its own timeline, so its lock is only contended
+// while EndFrame collects everything into the last frame's profile
+class JobProfiler {
+public:
+	JobProfiler(int amountOfWorkers, int maxEventsPerWorker);
+	~JobProfiler();
+	JobProfiler(JobProfiler const& copy) = delete;
+
+	void BeginFrame();
+	void EndFrame(JobSystem const& jobSystem);
+
+	void SetCapturing(bool isCapturing) { m_isCapturing = isCapturing; }
+	bool IsCapturing() const { return m_isCapturing.load(std::memory_order_relaxed); }
+
+	void RecordJob(JobTimelineEvent const& timelineEvent);
+	void RecordParking(int workerId, double parkedSeconds);
+
+	JobFrameProfile const& GetLastFrameProfile() const { return m_lastFrameProfile; } // Only valid on the thread calling EndFrame
+
+private:
+	struct WorkerTimeline {
+		std::mutex m_mutex;
+		std::vector<JobTimelineEvent> m_events;
+		JobWorkerStats m_stats;
+		int m_amountOfDroppedEvents = 0;
+	};
+
+	WorkerTimeline& GetTimeline(int workerId);
+
+private:
+	std::vector<WorkerTimeline*> m_timelines; // One per worker, the helping threads last
+	int m_maxEventsPerWorker = 0;
+	std::atomic<bool> m_isCapturing = true;
+	int m_frameIndex = 0;
+	double m_frameStartTime = 0.0;
+	JobFrameProfile m_lastFrameProfile;
+};
+
+void WriteChromeTrace(JobFrameProfile const& frameProfile, std::string& out_traceJson);
+bool ExportChromeTrace(JobFrameProfile const& frameProfile, std::string const& filePath);
+void GetJobFrameProfileReport(JobFrameProfile const& frameProfile, std::vector<std::string>& out_reportLines);
+
+bool Command_JobSystemTrace(EventArgs& args);
@@ -1,27 +1,94 @@
 #include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/JobProfiler.hpp"
+#include "Engine/Core/WorkStealingDeque.hpp"
+#include "Engine/Core/CpuTopology.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <chrono>
+#include <typeinfo>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() std::this_thread::yield()
+#endif
 
 JobSystem* g_theJobSystem = nullptr;
 
+static int GetLowestSetBit(unsigned int bits)
+{
+#if defined(_MSC_VER)
+	unsigned long bitIndex = 0;
+	_BitScanForward(&bitIndex, bits);
+	return (int)bitIndex;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+
+static thread_local JobWorkerThread* s_currentWorkerThread = nullptr; // Lets QueueJob push into the calling worker's own deque
+
 JobWorkerThread::JobWorkerThread(JobSystem* jobSystem, int threadID) :
 	m_theJobSystem(jobSystem),
 	m_threadID(threadID)
+{
+	m_localJobs = new WorkStealingDeque(jobSystem->m_config.m_workStealingDequeCapacity);
+	m_spinBudget = jobSystem->m_config.m_spinCountBeforeParking;
+}
+
+JobWorkerThread::~JobWorkerThread()
+{
+	delete m_localJobs;
+	m_localJobs = nullptr;
+}
+
+void JobWorkerThread::StartThread()
 {
 	m_thread = new std::thread(&JobWorkerThread::WorkerThreadMain, this);
 }
 
 void JobWorkerThread::WorkerThreadMain()
 {
+	s_currentWorkerThread = this;
+	if (m_logicalCoreId >= 0) {
+		PinCurrentThreadToLogicalCore(m_logicalCoreId);
+	}
+
+	int maxSpinBudget = m_theJobSystem->m_config.m_spinCountBeforeParking;
+	int minSpinBudget = maxSpinBudget / 8;
+	int spinCount = 0;
+
 	while (!m_isQuitting) {
-		Job* pendingJob = m_theJobSystem->ClaimJobToExecute(m_threadJobType);
-		if (pendingJob != nullptr) {
-			pendingJob->Execute();
-			pendingJob->OnFinished();
-			m_theJobSystem->MarkJobAsCompleted(pendingJob);
+		bool wasStolen = false;
+		Job* pendingJob = m_theJobSystem->ClaimJobToExecute(m_threadJobType.load(std::memory_order_relaxed), this, false, &wasStolen);
+
+		if (!pendingJob) {
+			if (spinCount < m_spinBudget) {
+				spinCount++;
+				CPU_RELAX();
+				continue;
+			}
+
+			// Spinning didn't pay off, so spin less next time
+			m_spinBudget = (m_spinBudget / 2 > minSpinBudget) ? m_spinBudget / 2 : minSpinBudget;
+			pendingJob = m_theJobSystem->ClaimJobOrPark(this, &wasStolen);
 		}
-		else {
-			std::this_thread::sleep_for(std::chrono::microseconds(1));
+		else if (spinCount > 0) {
+			m_spinBudget = (m_spinBudget * 2 < maxSpinBudget) ? m_spinBudget * 2 : maxSpinBudget;
+		}
+
+		spinCount = 0;
+		if (pendingJob != nullptr) {
+			m_theJobSystem->ExecuteJob(pendingJob, this, wasStolen);
 		}
 	}
+
+	s_currentWorkerThread = nullptr;
 }
 
 void JobWorkerThread::JoinAndDeleteThread()
@@ -46,187 +113,910 @@ JobSystem::~JobSystem()
 
 void JobSystem::Startup()
 {
+	if (m_config.m_enableProfiling) {
+		m_profiler = new JobProfiler(m_config.m_amountOfThreads, m_config.m_maxProfiledJobsPerWorker);
+	}
+
 	m_workerThreads.reserve(m_config.m_amountOfThreads);
 	for (int threadId = 0; threadId < m_config.m_amountOfThreads; threadId++) {
 		JobWorkerThread* workerThread = new JobWorkerThread(this, threadId);
 		m_workerThreads.push_back(workerThread);
 	}
 
-	m_jobsOnExecution.reserve(m_config.m_amountOfThreads);
+	UpdateSubscribedTypeBits();
+
+	if (m_config.m_pinWorkerThreads) {
+		AssignWorkerCores();
+	}
+
+	// Threads only start once every worker exists, as they steal from each other
+	for (int threadId = 0; threadId < m_config.m_amountOfThreads; threadId++) {
+		m_workerThreads[threadId]->StartThread();
+	}
 }
 
 void JobSystem::Shutdown()
 {
-	for (int threadId = 0; threadId < m_config.m_amountOfThreads; threadId++) {
-		JobWorkerThread* workerThread = m_workerThreads[threadId];
+	// Every worker has to be joined before any gets deleted, as the remaining ones could still be stealing from it
+	for (int threadId = 0; threadId < m_workerThreads.size(); threadId++) {
+		m_workerThreads[threadId]->m_isQuitting = true;
+	}
+	WakeWorkerThreads(true);
 
-		if (workerThread) {
-			workerThread->JoinAndDeleteThread();
-			delete workerThread;
-			workerThread = nullptr;
+	for (int threadId = 0; threadId < m_workerThreads.size(); threadId++) {
+		m_workerThreads[threadId]->JoinAndDeleteThread();
+	}
+
+	for (int threadId = 0; threadId < m_workerThreads.size(); threadId++) {
+		JobWorkerThread*& workerThread = m_workerThreads[threadId];
+		delete workerThread;
+		workerThread = nullptr;
+	}
+
+	m_workerThreads.clear();
+
+	delete m_profiler;
+	m_profiler = nullptr;
+}
+
+void JobSystem::AssignWorkerCores()
+{
+	CpuTopology cpuTopology;
+	cpuTopology.Detect();
+
+	std::vector<int> coreOrder;
+	cpuTopology.GetWorkerCoreOrder(coreOrder);
+	if (m_config.m_reserveCoreForMainThread && ((int)coreOrder.size() > m_config.m_amountOfThreads) && (coreOrder.size() > 1)) {
+		coreOrder.erase(coreOrder.begin());
+	}
+
+	std::vector<int> workerCoreIndexes;
+	for (int threadId = 0; threadId < m_workerThreads.size(); threadId++) {
+		int coreIndex = coreOrder[threadId % coreOrder.size()];
+		workerCoreIndexes.push_back(coreIndex);
+		m_workerThreads[threadId]->m_logicalCoreId = cpuTopology.GetLogicalCore(coreIndex).m_logicalCoreId;
+	}
+
+	// Closest victims first, ties keep the usual round-robin order starting after the thief, so the same victim isn't everyone's first pick
+	int amountOfWorkers = (int)m_workerThreads.size();
+	for (int thiefId = 0; thiefId < amountOfWorkers; thiefId++) {
+		std::vector<int>& stealOrder = m_workerThreads[thiefId]->m_stealOrder;
+		stealOrder.clear();
+		for (int victimOffset = 1; victimOffset < amountOfWorkers; victimOffset++) {
+			stealOrder.push_back((thiefId + victimOffset) % amountOfWorkers);
 		}
+
+		int thiefCoreIndex = workerCoreIndexes[thiefId];
+		std::stable_sort(stealOrder.begin(), stealOrder.end(), [&cpuTopology, &workerCoreIndexes, thiefCoreIndex](int firstVictim, int secondVictim) {
+			return cpuTopology.GetCoreDistance(thiefCoreIndex, workerCoreIndexes[firstVictim]) < cpuTopology.GetCoreDistance(thiefCoreIndex, workerCoreIndexes[secondVictim]);
+		});
 	}
 }
 
+int JobSystem::GetWorkerLogicalCore(int threadId) const
+{
+	if (threadId < 0 || threadId >= m_workerThreads.size()) return -1;
+	return m_workerThreads[threadId]->m_logicalCoreId;
+}
+
 void JobSystem::BeginFrame()
 {
+	if (m_profiler) {
+		m_profiler->BeginFrame();
+	}
+
+	if (m_config.m_frameBudgetSeconds > 0.0) {
+		m_frameDeadline = GetCurrentTimeSeconds() + m_config.m_frameBudgetSeconds;
+	}
+
+	// Background jobs held back during the last frame could have been left with every worker parked
+	if (m_priorityQueuedJobs[(int)JobPriority::BACKGROUND].m_amountOfJobs.load() > 0) {
+		WakeWorkerThreads(true);
+	}
 }
 
 void JobSystem::EndFrame()
 {
+	if (m_profiler) {
+		m_profiler->EndFrame(*this);
+	}
 }
 
 Job* JobSystem::ClaimJobToExecute(int threadJobType)
 {
-	Job* queuedJob = nullptr;
-	m_queuedJobsMutex.lock(); // lock
+	return ClaimJobToExecute(threadJobType, GetCurrentWorkerThread());
+}
 
-	if (!m_queuedJobs.empty()) {
-		bool foundJob = false;
-		std::deque<Job*>::iterator foundJobIt;
-		for (std::deque<Job*>::iterator dequeIt = m_queuedJobs.begin(); dequeIt != m_queuedJobs.end() && !foundJob; dequeIt++) {
-			if (*dequeIt) {
-				Job* job = *dequeIt;
-				int jobType = job->m_jobType;
-				if ((jobType & threadJobType) != 0) {
-					queuedJob = job;
-					foundJob = true;
-					foundJobIt = dequeIt;
-				}
-			}
-		}
-		//queuedJob = m_queuedJobs.front();
-		if (foundJob) {
-			m_queuedJobs.erase(foundJobIt);
-		}
+Job* JobSystem::ClaimJobToExecute(int threadJobType, JobWorkerThread* workerThread, bool isWaitingThread, bool* out_wasStolen)
+{
+	if (threadJobType == 0) return nullptr;
+
+	// Threads waiting on something don't take background jobs, those can run for longer than the wait itself
+	bool isBackgroundWorkAllowed = !isWaitingThread && IsBackgroundWorkAllowed();
+
+	Job* queuedJob = ClaimPriorityJob(JobPriority::CRITICAL);
+
+	if (!queuedJob && isBackgroundWorkAllowed && IsBackgroundQueueStarving()) {
+		queuedJob = ClaimPriorityJob(JobPriority::BACKGROUND);
 	}
 
-	m_queuedJobsMutex.unlock(); // unlock
+	if (!queuedJob) {
+		queuedJob = ClaimPriorityJob(JobPriority::HIGH);
+	}
 
+	if (!queuedJob && workerThread) {
+		queuedJob = workerThread->m_localJobs->Pop();
+	}
+
+	// Typed jobs are left alone by waiting threads, they might need something only their subscribed workers have
+	if (!queuedJob && !isWaitingThread) {
+		queuedJob = ClaimTypedJob(threadJobType);
+	}
+
+	if (!queuedJob) {
+		queuedJob = ClaimInjectedJob(workerThread);
+	}
+
+	if (!queuedJob) {
+		queuedJob = StealJob(workerThread);
+		if (queuedJob && out_wasStolen) {
+			*out_wasStolen = true;
+		}
+	}
+
+	if (!queuedJob && isBackgroundWorkAllowed) {
+		queuedJob = ClaimPriorityJob(JobPriority::BACKGROUND);
+	}
 
 	if (queuedJob) {
+		// Executing count goes up before queued count goes down, so waiters never see both at 0 while a job is in flight
+		m_amountOfExecutingJobs++;
 		m_amountOfQueuedJobs--;
-		int executionId = -1;
+		queuedJob->m_isExecuting = true;
+	}
 
-		m_jobsOnExecutionMutex.lock(); // lock
+	return queuedJob;
+}
 
-		for (executionId = 0; executionId < m_jobsOnExecution.size(); executionId++) {
-			Job* job = m_jobsOnExecution[executionId];
-			if (!job) break;
+JobWorkerThread* JobSystem::GetCurrentWorkerThread() const
+{
+	JobWorkerThread* currentWorker = s_currentWorkerThread;
+	if (currentWorker && (currentWorker->m_theJobSystem == this)) return currentWorker;
+	return nullptr;
+}
+
+bool JobSystem::ExecuteQueuedJob()
+{
+	JobWorkerThread* workerThread = GetCurrentWorkerThread();
+	bool wasStolen = false;
+	Job* queuedJob = ClaimJobToExecute(MULTIPURPOSE_THREAD, workerThread, true, &wasStolen);
+	if (!queuedJob) return false;
+
+	ExecuteJob(queuedJob, workerThread, wasStolen);
+	return true;
+}
+
+void JobSystem::ExecuteJob(Job* job, JobWorkerThread* workerThread, bool wasStolen)
+{
+	job->m_wasStolen = wasStolen;
+	if (job->IsCancelled()) {
+		job->OnCancelled();
+		MarkJobAsCompleted(job);
+		return;
+	}
+
+	if (!IsProfiling()) {
+		job->Execute();
+		job->OnFinished();
+		MarkJobAsCompleted(job);
+		return;
+	}
+
+	// Everything gets read before completion, the job may be gone right after
+	JobTimelineEvent timelineEvent;
+	timelineEvent.m_jobName = typeid(*job).name();
+	timelineEvent.m_queuedTime = job->m_queuedTime;
+	timelineEvent.m_workerId = (workerThread) ? workerThread->m_threadID : -1;
+	timelineEvent.m_jobType = job->m_jobType;
+	timelineEvent.m_priority = job->m_priority;
+	timelineEvent.m_wasStolen = wasStolen;
+
+	timelineEvent.m_startTime = GetCurrentTimeSeconds();
+	job->Execute();
+	job->OnFinished();
+	timelineEvent.m_endTime = GetCurrentTimeSeconds();
+
+	// Recorded before completing, so a frame that waits on its jobs sees all of them in its own profile
+	m_profiler->RecordJob(timelineEvent);
+	MarkJobAsCompleted(job);
+}
+
+bool JobSystem::IsProfiling() const
+{
+	return m_profiler && m_profiler->IsCapturing();
+}
+
+Job* JobSystem::ClaimJobOrPark(JobWorkerThread* workerThread, bool* out_wasStolen)
+{
+	m_amountOfParkedWorkers++;
+	unsigned int wakeEpoch = m_wakeEpoch.load();
+
+	// Jobs queued before the parked count went up didn't wake anyone, so look one last time
+	Job* queuedJob = ClaimJobToExecute(workerThread->m_threadJobType.load(std::memory_order_relaxed), workerThread, false, out_wasStolen);
+	if (!queuedJob) {
+		double parkingStartTime = (IsProfiling()) ? GetCurrentTimeSeconds() : 0.0;
+
+		std::unique_lock<std::mutex> parkingLock(m_parkingMutex);
+		m_parkingCondition.wait(parkingLock, [this, wakeEpoch, workerThread]() {
+			return (m_wakeEpoch.load() != wakeEpoch) || workerThread->m_isQuitting;
+		});
+		parkingLock.unlock();
+
+		if (parkingStartTime > 0.0 && IsProfiling()) {
+			m_profiler->RecordParking(workerThread->m_threadID, GetCurrentTimeSeconds() - parkingStartTime);
 		}
-		if (executionId != -1) {
-			if (executionId >= m_jobsOnExecution.size()) {
-				m_jobsOnExecution.push_back(queuedJob);
-			}
-			else {
-				m_jobsOnExecution[executionId] = queuedJob;
+	}
+
+	m_amountOfParkedWorkers--;
+	return queuedJob;
+}
+
+void JobSystem::WakeWorkerThreads(bool wakeAllWorkers)
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst); // Queued job has to be visible before reading the parked count
+	if (m_amountOfParkedWorkers.load() == 0) return;
+
+	m_parkingMutex.lock();
+	m_wakeEpoch++;
+	m_parkingMutex.unlock();
+
+	if (wakeAllWorkers) {
+		m_parkingCondition.notify_all();
+	}
+	else {
+		m_parkingCondition.notify_one();
+	}
+}
+
+void JobSystem::NotifyWaitingThreads()
+{
+	if (m_amountOfWaitingThreads.load() == 0) return;
+
+	// Taking the lock guarantees the waiter is either still before its check or already asleep
+	m_waitingMutex.lock();
+	m_waitingEpoch++;
+	m_waitingMutex.unlock();
+	m_waitingCondition.notify_all();
+}
+
+template<typename T_Predicate>
+bool JobSystem::WaitUntil(T_Predicate isWaitOver, bool executeJobsWhileWaiting, double timeoutSeconds)
+{
+	double deadline = (timeoutSeconds >= 0.0) ? GetCurrentTimeSeconds() + timeoutSeconds : -1.0;
+
+	int spinCount = 0;
+	while (!isWaitOver()) {
+		if ((deadline >= 0.0) && (GetCurrentTimeSeconds() >= deadline)) return false;
+
+		// The awaited jobs are likely still queued, running them here beats sleeping until a worker gets to them
+		if (executeJobsWhileWaiting && ExecuteQueuedJob()) {
+			spinCount = 0;
+			continue;
+		}
+
+		if (spinCount < m_config.m_spinCountBeforeParking) {
+			spinCount++;
+			CPU_RELAX();
+			continue;
+		}
+
+		// Any completion wakes the waiter up, either the wait is over or it goes back to helping
+		m_amountOfWaitingThreads++;
+		std::unique_lock<std::mutex> waitingLock(m_waitingMutex);
+		unsigned int waitingEpoch = m_waitingEpoch;
+		auto isWokenUp = [this, waitingEpoch, &isWaitOver]() {
+			return (m_waitingEpoch != waitingEpoch) || isWaitOver();
+		};
+
+		if (deadline >= 0.0) {
+			double remainingSeconds = deadline - GetCurrentTimeSeconds();
+			if (remainingSeconds > 0.0) {
+				m_waitingCondition.wait_for(waitingLock, std::chrono::duration<double>(remainingSeconds), isWokenUp);
 			}
 		}
 		else {
-			executionId = (int)m_jobsOnExecution.size();
-			m_jobsOnExecution.push_back(queuedJob);
+			m_waitingCondition.wait(waitingLock, isWokenUp);
 		}
+		waitingLock.unlock();
+		m_amountOfWaitingThreads--;
+		spinCount = 0;
+	}
 
-		m_jobsOnExecutionMutex.unlock(); // unlock
+	return true;
+}
 
-		queuedJob->m_executionId = executionId;
-		m_amountOfExecutingJobs++;
+Job* JobSystem::ClaimTypedJob(int threadJobType)
+{
+	// Only queues that have jobs and that this thread subscribes to get touched, however many bits or jobs there are
+	unsigned int candidateBits = static_cast<unsigned int>(threadJobType) & m_queuedTypeBits.load(std::memory_order_relaxed);
+	while (candidateBits != 0) {
+		int typeBit = GetLowestSetBit(candidateBits);
+		candidateBits &= candidateBits - 1;
+
+		Job* queuedJob = nullptr;
+		TypedJobQueue& typedQueue = m_typedQueuedJobs[typeBit];
+		typedQueue.m_mutex.lock();
+		if (!typedQueue.m_jobs.empty()) {
+			queuedJob = typedQueue.m_jobs.front();
+			typedQueue.m_jobs.pop_front();
+			if (typedQueue.m_jobs.empty()) {
+				m_queuedTypeBits.fetch_and(~(1u << typeBit));
+			}
+		}
+		typedQueue.m_mutex.unlock();
+
+		if (queuedJob) return queuedJob;
+	}
+
+	return nullptr;
+}
+
+void JobSystem::PushTypedJob(Job* job)
+{
+	std::shared_lock<std::shared_mutex> jobTypesLock(m_threadJobTypesMutex);
+
+	int typeBit = GetTypedQueueIndex(job->m_jobType);
+	TypedJobQueue& typedQueue = m_typedQueuedJobs[typeBit];
+	typedQueue.m_mutex.lock();
+	typedQueue.m_jobs.push_back(job);
+	if (typedQueue.m_jobs.size() == 1) {
+		m_queuedTypeBits.fetch_or(1u << typeBit);
+	}
+	typedQueue.m_mutex.unlock();
+}
 
+void JobSystem::UpdateSubscribedTypeBits()
+{
+	unsigned int subscribedTypeBits = 0;
+	for (int threadId = 0; threadId < m_workerThreads.size(); threadId++) {
+		subscribedTypeBits |= static_cast<unsigned int>(m_workerThreads[threadId]->m_threadJobType.load());
 	}
+	m_subscribedTypeBits = subscribedTypeBits;
+}
+
+Job* JobSystem::ClaimPriorityJob(JobPriority priority)
+{
+	PriorityJobQueue& priorityQueue = m_priorityQueuedJobs[(int)priority];
+	if (priorityQueue.m_amountOfJobs.load(std::memory_order_relaxed) == 0) return nullptr;
+
+	Job* queuedJob = nullptr;
+	priorityQueue.m_mutex.lock();
+	if (!priorityQueue.m_jobs.empty()) {
+		queuedJob = priorityQueue.m_jobs.front();
+		priorityQueue.m_jobs.pop_front();
+		priorityQueue.m_amountOfJobs--;
+		priorityQueue.m_frontQueuedTime = (priorityQueue.m_jobs.empty()) ? 0.0 : priorityQueue.m_jobs.front()->m_queuedTime;
+	}
+	priorityQueue.m_mutex.unlock();
 
 	return queuedJob;
 }
 
+bool JobSystem::IsBackgroundWorkAllowed() const
+{
+	if (m_amountOfCriticalJobsInFlight.load() == 0) return true;
 
-void JobSystem::QueueJob(Job* job)
+	double frameDeadline = m_frameDeadline.load();
+	if (frameDeadline <= 0.0) return true;
+
+	// Past the deadline the frame is late anyway, holding background work back any longer would only starve it
+	return GetCurrentTimeSeconds() >= frameDeadline;
+}
+
+bool JobSystem::IsBackgroundQueueStarving() const
 {
-	m_queuedJobsMutex.lock();
-	m_queuedJobs.push_back(job);
-	m_queuedJobsMutex.unlock();
+	PriorityJobQueue const& backgroundQueue = m_priorityQueuedJobs[(int)JobPriority::BACKGROUND];
+	if (backgroundQueue.m_amountOfJobs.load(std::memory_order_relaxed) == 0) return false;
 
-	m_amountOfQueuedJobs++;
+	double frontQueuedTime = backgroundQueue.m_frontQueuedTime.load();
+	return (frontQueuedTime > 0.0) && ((GetCurrentTimeSeconds() - frontQueuedTime) > m_config.m_backgroundStarvationSeconds);
+}
 
+bool JobSystem::ShouldBackgroundJobsYield() const
+{
+	return !IsBackgroundWorkAllowed();
 }
 
-void JobSystem::MarkJobAsCompleted(Job* job)
+Job* JobSystem::ClaimInjectedJob(JobWorkerThread* workerThread)
+{
+	if (m_amountOfInjectedJobs.load(std::memory_order_relaxed) == 0) return nullptr;
+
+	Job* queuedJob = nullptr;
+	m_queuedJobsMutex.lock(); // lock
+
+	if (!m_queuedJobs.empty()) {
+		queuedJob = m_queuedJobs.front();
+		m_queuedJobs.pop_front();
+		m_amountOfInjectedJobs--;
+
+		// Move a batch into this worker's deque so the rest of the workers can steal it without touching this mutex
+		if (workerThread) {
+			int batchSize = (int)m_queuedJobs.size() / ((int)m_workerThreads.size() + 1);
+			if (batchSize > INJECTED_JOBS_BATCH_SIZE) batchSize = INJECTED_JOBS_BATCH_SIZE;
+
+			for (int batchIndex = 0; batchIndex < batchSize; batchIndex++) {
+				workerThread->m_localJobs->Push(m_queuedJobs.front());
+				m_queuedJobs.pop_front();
+			}
+			m_amountOfInjectedJobs -= batchSize;
+		}
+	}
+
+	m_queuedJobsMutex.unlock(); // unlock
+
+	return queuedJob;
+}
+
+Job* JobSystem::StealJob(JobWorkerThread* thiefThread)
 {
-	if (job->m_executionId < 0) return;
-	m_jobsOnExecutionMutex.lock(); // lock
+	// Pinned workers try their SMT siblings and cache neighbours first, whatever is in their deques was likely made with warm data
+	if (thiefThread && !thiefThread->m_stealOrder.empty()) {
+		std::vector<int> const& stealOrder = thiefThread->m_stealOrder;
+		for (int orderIndex = 0; orderIndex < stealOrder.size(); orderIndex++) {
+			Job* stolenJob = m_workerThreads[stealOrder[orderIndex]]->m_localJobs->Steal();
+			if (stolenJob) return stolenJob;
+		}
+		return nullptr;
+	}
 
-	if (job->m_executionId < m_jobsOnExecution.size()) {
-		m_jobsOnExecution[job->m_executionId] = nullptr;
+	int amountOfWorkers = (int)m_workerThreads.size();
+	int firstVictim = (thiefThread) ? thiefThread->m_threadID + 1 : 0;
+
+	for (int victimOffset = 0; victimOffset < amountOfWorkers; victimOffset++) {
+		JobWorkerThread* victimThread = m_workerThreads[(firstVictim + victimOffset) % amountOfWorkers];
+		if (victimThread == thiefThread) continue;
+
+		Job* stolenJob = victimThread->m_localJobs->Steal();
+		if (stolenJob) return stolenJob;
 	}
 
-	m_jobsOnExecutionMutex.unlock(); // unlock
+	return nullptr;
+}
 
+void JobSystem::PushCompletedJob(Job* job)
+{
+	Job* completedJobsHead = m_completedJobsHead.load(std::memory_order_relaxed);
+	do {
+		job->m_nextCompletedJob = completedJobsHead;
+	} while (!m_completedJobsHead.compare_exchange_weak(completedJobsHead, job, std::memory_order_release, std::memory_order_relaxed));
+}
 
-	m_completedJobsMutex.lock(); // lock
+void JobSystem::TakeCompletedJobs()
+{
+	Job* newestJob = m_completedJobsHead.exchange(nullptr, std::memory_order_acquire);
+
+	// The list comes newest first, retrieval hands jobs out in completion order
+	Job* oldestJob = nullptr;
+	while (newestJob) {
+		Job* nextJob = newestJob->m_nextCompletedJob;
+		newestJob->m_nextCompletedJob = oldestJob;
+		oldestJob = newestJob;
+		newestJob = nextJob;
+	}
 
-	m_completedJobs.push_back(job);
+	m_retrievedCompletedJobs = oldestJob;
+}
 
-	m_completedJobsMutex.unlock(); // unlock
+bool JobSystem::ReleaseOwnedJob(Job* job)
+{
+	if (job->m_poolBlockIndex >= 0) {
+		int blockIndex = job->m_poolBlockIndex;
+		job->~Job();
+		m_jobPool.Free(blockIndex);
+		return true;
+	}
+
+	if (job->m_deleteOnCompletion) {
+		delete job;
+		return true;
+	}
+
+	return false;
+}
+
+int JobSystem::GetTypedQueueIndex(int jobType) const
+{
+	// Jobs with several type bits go to the first bit that has a worker subscribed, so some worker can always claim them
+	unsigned int jobTypeBits = static_cast<unsigned int>(jobType);
+	unsigned int claimableBits = jobTypeBits & m_subscribedTypeBits.load(std::memory_order_relaxed);
+	return GetLowestSetBit((claimableBits != 0) ? claimableBits : jobTypeBits);
+}
+
+
+void JobSystem::QueueJob(Job* job, JobCounter* completionCounter)
+{
+	if (completionCounter) {
+		completionCounter->m_value++;
+		job->m_completionCounter = completionCounter;
+	}
+
+	EnqueueJob(job);
+}
+
+void JobSystem::QueueJobAfter(Job* job, JobCounter& dependency, JobCounter* completionCounter)
+{
+	std::vector<JobCounter*> dependencies;
+	dependencies.push_back(&dependency);
+	QueueJobAfter(job, dependencies, completionCounter);
+}
+
+void JobSystem::QueueJobAfter(Job* job, std::vector<JobCounter*> const& dependencies, JobCounter* completionCounter)
+{
+	if (completionCounter) {
+		completionCounter->m_value++;
+		job->m_completionCounter = completionCounter;
+	}
+
+	// The extra dependency keeps the job from being queued by a counter that finishes while the rest are still being registered
+	job->m_amountOfPendingDependencies = (int)dependencies.size() + 1;
+	m_amountOfWaitingJobs++;
+
+	for (int dependencyIndex = 0; dependencyIndex < dependencies.size(); dependencyIndex++) {
+		JobCounter* dependency = dependencies[dependencyIndex];
+		bool isDependencyMet = true;
+
+		if (dependency) {
+			dependency->m_continuationsMutex.lock();
+			if (dependency->m_value.load() != 0) {
+				dependency->m_continuations.push_back(job);
+				isDependencyMet = false;
+			}
+			dependency->m_continuationsMutex.unlock();
+		}
+
+		if (isDependencyMet) {
+			job->m_amountOfPendingDependencies--;
+		}
+	}
+
+	if (--job->m_amountOfPendingDependencies == 0) {
+		EnqueueJob(job);
+		m_amountOfWaitingJobs--;
+	}
+}
+
+void JobSystem::SignalCounter(JobCounter& counter, std::vector<Job*>* out_droppedContinuations)
+{
+	std::vector<Job*> releasedJobs;
+	bool isCounterComplete = false;
+
+	// Decrementing under the lock means a job registering as a continuation either sees the counter done or gets released here
+	counter.m_continuationsMutex.lock();
+	if (--counter.m_value == 0) {
+		releasedJobs.swap(counter.m_continuations);
+		isCounterComplete = true;
+	}
+	counter.m_continuationsMutex.unlock();
+
+	// The counter may be gone as soon as the lock is released
+	if (isCounterComplete) {
+		NotifyWaitingThreads();
+	}
+
+	for (int jobIndex = 0; jobIndex < releasedJobs.size(); jobIndex++) {
+		Job* releasedJob = releasedJobs[jobIndex];
+		if (--releasedJob->m_amountOfPendingDependencies == 0) {
+			if (out_droppedContinuations) {
+				out_droppedContinuations->push_back(releasedJob);
+			}
+			else {
+				EnqueueJob(releasedJob);
+			}
+			m_amountOfWaitingJobs--;
+		}
+	}
+}
+
+void JobSystem::EnqueueJob(Job* job)
+{
+	m_amountOfQueuedJobs++;
+	if (IsProfiling()) {
+		job->m_queuedTime = GetCurrentTimeSeconds();
+	}
+	if (job->m_priority == JobPriority::CRITICAL) {
+		m_amountOfCriticalJobsInFlight++;
+	}
+
+	int jobType = job->m_jobType;
+	if ((jobType != MULTIPURPOSE_THREAD) && (jobType != 0)) {
+		PushTypedJob(job);
+		WakeWorkerThreads(true); // Only some workers can take it, and there's no telling which one is parked
+		return;
+	}
+
+	if (job->m_priority != JobPriority::NORMAL) {
+		PriorityJobQueue& priorityQueue = m_priorityQueuedJobs[(int)job->m_priority];
+		job->m_queuedTime = GetCurrentTimeSeconds();
+
+		priorityQueue.m_mutex.lock();
+		if (priorityQueue.m_jobs.empty()) {
+			priorityQueue.m_frontQueuedTime = job->m_queuedTime;
+		}
+		priorityQueue.m_jobs.push_back(job);
+		priorityQueue.m_amountOfJobs++;
+		priorityQueue.m_mutex.unlock();
+
+		WakeWorkerThreads(false);
+		return;
+	}
+
+	// Multipurpose jobs (and jobs without type bits) can run anywhere
+	JobWorkerThread* currentWorker = GetCurrentWorkerThread();
+	if (currentWorker) {
+		currentWorker->m_localJobs->Push(job);
+	}
+	else {
+		m_queuedJobsMutex.lock();
+		m_queuedJobs.push_back(job);
+		m_amountOfInjectedJobs++;
+		m_queuedJobsMutex.unlock();
+	}
+
+	WakeWorkerThreads(false);
+}
+
+void JobSystem::MarkJobAsCompleted(Job* job)
+{
+	if (!job->m_isExecuting) return;
+	job->m_isExecuting = false;
+
+	// Continuations get queued before this job stops counting as executing, so waiters never see an empty system in between
+	if (job->m_completionCounter) {
+		SignalCounter(*job->m_completionCounter);
+	}
+
+	if (job->m_priority == JobPriority::CRITICAL) {
+		// Workers may have parked on background jobs that were held back for this one
+		if ((--m_amountOfCriticalJobsInFlight == 0) && (m_priorityQueuedJobs[(int)JobPriority::BACKGROUND].m_amountOfJobs.load() > 0)) {
+			WakeWorkerThreads(true);
+		}
+	}
+
+	// The retrieving thread may delete the job as soon as it's pushed
+	if (!ReleaseOwnedJob(job)) {
+		PushCompletedJob(job);
+	}
 
 	m_amountOfExecutingJobs--;
+	NotifyWaitingThreads();
 
 }
 
 Job* JobSystem::RetrieveCompletedJob()
 {
-	m_completedJobsMutex.lock();
 	Job* completedJob = nullptr;
-	if (!m_completedJobs.empty())
-	{
-		completedJob = m_completedJobs.front();
-		m_completedJobs.pop_front();
-	}
-	m_completedJobsMutex.unlock();
+	RetrieveCompletedJobs(&completedJob, 1);
 	return completedJob;
 }
 
+int JobSystem::RetrieveCompletedJobs(Job** out_completedJobs, int maxAmountOfJobs)
+{
+	int amountOfRetrievedJobs = 0;
+	while (amountOfRetrievedJobs < maxAmountOfJobs) {
+		if (!m_retrievedCompletedJobs) {
+			TakeCompletedJobs();
+			if (!m_retrievedCompletedJobs) break;
+		}
+
+		Job* completedJob = m_retrievedCompletedJobs;
+		m_retrievedCompletedJobs = completedJob->m_nextCompletedJob;
+		completedJob->m_nextCompletedJob = nullptr;
+		out_completedJobs[amountOfRetrievedJobs++] = completedJob;
+	}
+
+	return amountOfRetrievedJobs;
+}
+
+void JobSystem::RetrieveCompletedJobs(std::vector<Job*>& out_completedJobs)
+{
+	if (!m_retrievedCompletedJobs) {
+		TakeCompletedJobs();
+	}
+
+	while (m_retrievedCompletedJobs) {
+		Job* completedJob = m_retrievedCompletedJobs;
+		m_retrievedCompletedJobs = completedJob->m_nextCompletedJob;
+		completedJob->m_nextCompletedJob = nullptr;
+		out_completedJobs.push_back(completedJob);
+	}
+}
+
 void JobSystem::ClearQueuedJobs()
 {
-	m_amountOfQueuedJobs = 0;
+	std::vector<Job*> clearedJobs;
+
 	m_queuedJobsMutex.lock();
+	clearedJobs.insert(clearedJobs.end(), m_queuedJobs.begin(), m_queuedJobs.end());
+	m_amountOfInjectedJobs = 0;
 	m_queuedJobs.clear();
 	m_queuedJobsMutex.unlock();
 
+	for (int typeBit = 0; typeBit < MAX_JOB_TYPE_BITS; typeBit++) {
+		TypedJobQueue& typedQueue = m_typedQueuedJobs[typeBit];
+		typedQueue.m_mutex.lock();
+		clearedJobs.insert(clearedJobs.end(), typedQueue.m_jobs.begin(), typedQueue.m_jobs.end());
+		typedQueue.m_jobs.clear();
+		m_queuedTypeBits.fetch_and(~(1u << typeBit));
+		typedQueue.m_mutex.unlock();
+	}
+
+	for (int priorityIndex = 0; priorityIndex < (int)JobPriority::NUM_JOB_PRIORITIES; priorityIndex++) {
+		PriorityJobQueue& priorityQueue = m_priorityQueuedJobs[priorityIndex];
+		priorityQueue.m_mutex.lock();
+		clearedJobs.insert(clearedJobs.end(), priorityQueue.m_jobs.begin(), priorityQueue.m_jobs.end());
+		priorityQueue.m_amountOfJobs = 0;
+		priorityQueue.m_frontQueuedTime = 0.0;
+		priorityQueue.m_jobs.clear();
+		priorityQueue.m_mutex.unlock();
+	}
+
+	// Worker deques can only be emptied from the outside by stealing from them
+	for (int threadId = 0; threadId < m_workerThreads.size(); threadId++) {
+		WorkStealingDeque* localJobs = m_workerThreads[threadId]->m_localJobs;
+		while (!localJobs->IsEmpty()) {
+			Job* stolenJob = localJobs->Steal();
+			if (stolenJob) clearedJobs.push_back(stolenJob);
+		}
+	}
+
+	// Dropped jobs still signal their counters, otherwise anything waiting on them never returns. Continuations they release
+	// never got queued, so they're dropped (and signal their own counters) too instead of running after the clear
+	int amountOfQueuedJobs = (int)clearedJobs.size();
+	for (int jobIndex = 0; jobIndex < clearedJobs.size(); jobIndex++) {
+		Job* clearedJob = clearedJobs[jobIndex];
+		if ((jobIndex < amountOfQueuedJobs) && (clearedJob->m_priority == JobPriority::CRITICAL)) {
+			m_amountOfCriticalJobsInFlight--;
+		}
+		if (clearedJob->m_completionCounter) {
+			SignalCounter(*clearedJob->m_completionCounter, &clearedJobs);
+		}
+
+		// Nobody else holds on to jobs the JobSystem owns, so they'd leak
+		ReleaseOwnedJob(clearedJob);
+	}
+
+	m_amountOfQueuedJobs -= amountOfQueuedJobs;
+	NotifyWaitingThreads();
 }
 
 void JobSystem::ClearCompletedJobs()
 {
-	m_completedJobsMutex.lock();
-	m_completedJobs.clear();
-	m_completedJobsMutex.unlock();
+	m_retrievedCompletedJobs = nullptr;
+	m_completedJobsHead.exchange(nullptr, std::memory_order_acquire);
 }
 
 void JobSystem::WaitUntilQueuedJobsCompletion()
 {
-	bool keepRunning = true;
-	while (keepRunning) {
-		keepRunning = (m_amountOfExecutingJobs != 0) || (m_amountOfQueuedJobs != 0);
+	WaitUntilQueuedJobsCompletion(-1.0);
+}
 
-		if (keepRunning) {
-			std::this_thread::sleep_for(std::chrono::microseconds(1));
-		}
-	} // Do nothing while there are queued or running jobs
+bool JobSystem::WaitUntilQueuedJobsCompletion(double timeoutSeconds)
+{
+	return WaitUntil([this]() {
+		return (m_amountOfExecutingJobs == 0) && (m_amountOfQueuedJobs == 0) && (m_amountOfWaitingJobs == 0);
+	}, m_config.m_executeJobsWhileWaiting, timeoutSeconds);
 }
 
 void JobSystem::WaitUntilCurrentJobsCompletion()
 {
-	bool keepRunning = true;
-	while (keepRunning) {
-		keepRunning = (m_amountOfExecutingJobs != 0);
-		if (keepRunning) {
-			std::this_thread::sleep_for(std::chrono::microseconds(1));
-		}
+	WaitUntil([this]() {
+		return (m_amountOfExecutingJobs == 0);
+	}, false);
+}
+
+void JobSystem::WaitUntilCounterCompletion(JobCounter const& counter)
+{
+	WaitUntilCounterCompletion(counter, -1.0);
+}
+
+bool JobSystem::WaitUntilCounterCompletion(JobCounter const& counter, double timeoutSeconds, JobCancellationToken const* cancellationToken)
+{
+	bool isCounterComplete = WaitUntil([&counter, cancellationToken]() {
+		return counter.IsComplete() || (cancellationToken && cancellationToken->IsCancelled());
+	}, m_config.m_executeJobsWhileWaiting, timeoutSeconds);
+	if (!isCounterComplete || !counter.IsComplete()) return false;
+
+	// The last signaling thread could still be releasing the lock, so the counter isn't safe to destroy until it's done
+	counter.m_continuationsMutex.lock();
+	counter.m_continuationsMutex.unlock();
+	return true;
+}
+
+void JobSystem::HelpUntilCounterCompletion(JobCounter const& counter)
+{
+	WaitUntil([&counter]() {
+		return counter.IsComplete();
+	}, true);
+
+	counter.m_continuationsMutex.lock();
+	counter.m_continuationsMutex.unlock();
+}
+
+bool JobSystem::WaitUntilFlagIsSet(std::atomic<bool> const& flag, double timeoutSeconds)
+{
+	return WaitUntil([&flag]() {
+		return flag.load();
+	}, m_config.m_executeJobsWhileWaiting, timeoutSeconds);
+}
+
+void JobSystem::AddPendingWork(JobCounter& counter, int amountOfWork)
+{
+	counter.m_value += amountOfWork;
+}
 
-	} // Do nothing while there are running jobs
+void JobSystem::CompletePendingWork(JobCounter& counter)
+{
+	SignalCounter(counter);
+}
+
+void JobSystem::Cancel(JobCancellationToken& cancellationToken)
+{
+	cancellationToken.m_isCancelled.store(true, std::memory_order_release);
+
+	// Skipped jobs still have to be claimed, so idle workers should get to them, and waits on the token can return now
+	WakeWorkerThreads(true);
+	NotifyWaitingThreads();
 }
 
 void JobSystem::SetThreadJobType(int threadId, int jobType)
 {
-	if (threadId < 0 || threadId > m_workerThreads.size()) return;
-	m_workerThreads[threadId]->m_threadJobType = jobType;
+	if (threadId < 0 || threadId >= m_workerThreads.size()) return;
+
+	// The worker picks the new type up on its next claim. Typed jobs can't be routed while subscriptions are changing
+	std::vector<Job*> reroutedJobs;
+	{
+		std::unique_lock<std::shared_mutex> jobTypesLock(m_threadJobTypesMutex);
+		m_workerThreads[threadId]->m_threadJobType = jobType;
+		UpdateSubscribedTypeBits();
+
+		// Jobs with several type bits could be sitting on a bit nobody takes anymore while another of their bits has a worker
+		unsigned int subscribedTypeBits = m_subscribedTypeBits.load();
+		unsigned int orphanedTypeBits = m_queuedTypeBits.load() & ~subscribedTypeBits;
+		while (orphanedTypeBits != 0) {
+			int typeBit = GetLowestSetBit(orphanedTypeBits);
+			orphanedTypeBits &= orphanedTypeBits - 1;
+
+			TypedJobQueue& typedQueue = m_typedQueuedJobs[typeBit];
+			typedQueue.m_mutex.lock();
+			auto stayingJobsEnd = std::stable_partition(typedQueue.m_jobs.begin(), typedQueue.m_jobs.end(), [subscribedTypeBits](Job* queuedJob) {
+				return (static_cast<unsigned int>(queuedJob->m_jobType.load()) & subscribedTypeBits) == 0;
+			});
+			reroutedJobs.insert(reroutedJobs.end(), stayingJobsEnd, typedQueue.m_jobs.end());
+			typedQueue.m_jobs.erase(stayingJobsEnd, typedQueue.m_jobs.end());
+			if (typedQueue.m_jobs.empty()) {
+				m_queuedTypeBits.fetch_and(~(1u << typeBit));
+			}
+			typedQueue.m_mutex.unlock();
+		}
+	}
+
+	for (int jobIndex = 0; jobIndex < reroutedJobs.size(); jobIndex++) {
+		PushTypedJob(reroutedJobs[jobIndex]);
+	}
+
+	// Parked workers might have just subscribed to bits that already have jobs queued
+	WakeWorkerThreads(true);
+}
+
+int JobSystem::GetThreadJobType(int threadId) const
+{
+	if (threadId < 0 || threadId >= m_workerThreads.size()) return 0;
+	return m_workerThreads[threadId]->m_threadJobType.load();
+}
+
+bool Job::IsCancelled() const
+{
+	return m_cancellationToken && m_cancellationToken->IsCancelled();
 }
 
 Job::Job(int jobType) :
@@ -1,20 +1,70 @@
 #pragma once
+#include "Engine/Core/JobPool.hpp"
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 
 struct JobSystemConfig {
 	int m_amountOfThreads = 0;
+	int m_workStealingDequeCapacity = 256; // Initial capacity of each worker's deque, grows on demand
+	int m_spinCountBeforeParking = 256; // Failed claim attempts before an idle worker (or waiting thread) goes to sleep. 0 parks right away
+	double m_frameBudgetSeconds = 0.0; // When > 0, BeginFrame sets a deadline. Until it passes, background jobs don't start while critical jobs are in flight
+	double m_backgroundStarvationSeconds = 0.1; // Background jobs queued longer than this get claimed ahead of normal jobs
+	bool m_pinWorkerThreads = false; // Each worker stays on one logical core (a physical core each first, SMT siblings last) and steals from its closest neighbours first
+	bool m_reserveCoreForMainThread = true; // When pinning, the first core is only used if there are more workers than other cores
+	bool m_enableProfiling = false; // Records every job's queue wait and execution time plus per-worker utilization, see JobProfiler
+	int m_maxProfiledJobsPerWorker = 16384; // Per frame, jobs past it only count in the worker's stats
+	bool m_executeJobsWhileWaiting = true; // Threads in WaitUntil* run queued jobs instead of sleeping. Waiters must not hold locks those jobs need
+};
+
+// Normal jobs take the work stealing path, every other priority has its own shared queue
+enum class JobPriority {
+	CRITICAL,
+	HIGH,
+	NORMAL,
+	BACKGROUND,
+	NUM_JOB_PRIORITIES
 };
 
 class Job;
+class JobCounter;
+class JobCancellationToken;
+class JobProfiler;
 class JobWorkerThread;
+class WorkStealingDeque;
 
 constexpr int MULTIPURPOSE_THREAD = ~0;
 constexpr int DEFAULT_JOB_ID = MULTIPURPOSE_THREAD;
+constexpr int MAX_JOB_TYPE_BITS = 32;
+constexpr int INJECTED_JOBS_BATCH_SIZE = 32; // Max multipurpose jobs a worker moves from the shared queue into its own deque at once
+
+// Jobs with specific job type bits can only run in some workers, so they can't go into the work stealing deques.
+// There's one queue per bit, and a worker only looks at the queues for bits it subscribes to that have jobs
+struct TypedJobQueue {
+	std::deque<Job*> m_jobs;
+	std::mutex m_mutex;
+};
+
+struct PriorityJobQueue {
+	std::deque<Job*> m_jobs;
+	std::mutex m_mutex;
+	std::atomic<int> m_amountOfJobs = 0;
+	std::atomic<double> m_frontQueuedTime = 0.0; // When the oldest job got queued, for starvation checks without locking
+};
+
+// The completed list and the job pool sit on their own cache lines, MSVC flags the padding that takes
+#pragma warning(push)
+#pragma warning(disable : 4324) // Structure was padded due to alignment specifier
 
 class JobSystem {
+	friend class JobWorkerThread;
 
 public:
 
@@ -27,37 +77,127 @@ public:
 	void EndFrame();
 
 	Job* ClaimJobToExecute(int threadJobType);
-	void QueueJob(Job* job);
+	void QueueJob(Job* job, JobCounter* completionCounter = nullptr);
+	void QueueJobAfter(Job* job, JobCounter& dependency, JobCounter* completionCounter = nullptr);
+	void QueueJobAfter(Job* job, std::vector<JobCounter*> const& dependencies, JobCounter* completionCounter = nullptr);
 	void MarkJobAsCompleted(Job* job);
+	// Completed jobs can only be retrieved (or cleared) from one thread at a time, usually the main thread
 	Job* RetrieveCompletedJob();
+	int RetrieveCompletedJobs(Job** out_completedJobs, int maxAmountOfJobs); // Oldest first, returns how many were written
+	void RetrieveCompletedJobs(std::vector<Job*>& out_completedJobs); // Appends every completed job
+	bool ExecuteQueuedJob(); // Runs one multipurpose job on the calling thread, so threads waiting on jobs can help instead of blocking
+
+	// Pooled jobs belong to the JobSystem: they are destroyed once completed and never come out of RetrieveCompletedJob
+	template<typename T_Job, typename... T_Args>
+	T_Job* CreatePooledJob(T_Args&&... args);
+	template<typename T_Function>
+	void QueueLambdaJob(T_Function&& function, JobCounter* completionCounter = nullptr, int jobType = DEFAULT_JOB_ID, JobPriority priority = JobPriority::NORMAL);
+	template<typename T_Function>
+	void QueueLambdaJobAfter(T_Function&& function, JobCounter& dependency, JobCounter* completionCounter = nullptr, int jobType = DEFAULT_JOB_ID, JobPriority priority = JobPriority::NORMAL);
 
 	void ClearQueuedJobs();
 	void ClearCompletedJobs();
-	void WaitUntilCurrentJobsCompletion();
+	// Waits run queued jobs on the calling thread (see m_executeJobsWhileWaiting), so a wait can take as long as the job it picked up.
+	// Timed and cancellable waits return false when they give up, the jobs still in flight keep using the counter, so it has to stay alive
+	void WaitUntilCurrentJobsCompletion(); // Only waits, running queued jobs would just add more current jobs
 	void WaitUntilQueuedJobsCompletion();
+	bool WaitUntilQueuedJobsCompletion(double timeoutSeconds);
+	void WaitUntilCounterCompletion(JobCounter const& counter);
+	bool WaitUntilCounterCompletion(JobCounter const& counter, double timeoutSeconds, JobCancellationToken const* cancellationToken = nullptr); // Negative timeout waits until complete or cancelled
+	// Always runs queued jobs, whatever m_executeJobsWhileWaiting says. For callers waiting on jobs they just queued themselves: a worker
+	// that only waited would leave them sitting in its own deque, and with nobody else to steal them it'd never wake up
+	void HelpUntilCounterCompletion(JobCounter const& counter);
+	// For things that finish without a counter (coroutine tasks, ...): waits like the others until the flag is set. Whoever sets it
+	// has to call NotifyWaitingThreads right after, or the waiter may sleep through it
+	bool WaitUntilFlagIsSet(std::atomic<bool> const& flag, double timeoutSeconds = -1.0);
+	void NotifyWaitingThreads();
+
+	// Work finishing outside of jobs (file reads, ...) can hold a counter too, so jobs can wait on it or get queued after it
+	void AddPendingWork(JobCounter& counter, int amountOfWork = 1);
+	void CompletePendingWork(JobCounter& counter);
 
-	void SetThreadJobType(int threadId, int jobType);
+	void Cancel(JobCancellationToken& cancellationToken); // Queued jobs holding the token get skipped, waits on it return right away
+
+	void SetThreadJobType(int threadId, int jobType); // Safe while jobs are running, queued jobs follow the new subscriptions
+	int GetThreadJobType(int threadId) const;
+
+	bool ShouldBackgroundJobsYield() const; // Long background jobs can poll this and requeue the rest of their work
+	double GetFrameDeadline() const { return m_frameDeadline.load(); }
 
 	int GetNumThreads() const { return m_config.m_amountOfThreads; }
+	int GetWorkerLogicalCore(int threadId) const; // -1 when workers aren't pinned
+	int GetAmountOfJobHeapAllocations() const { return m_jobPool.GetAmountOfHeapAllocations(); }
+	int GetAmountOfPooledJobsInUse() const { return m_jobPool.GetAmountOfBlocksInUse(); }
+	JobProfiler* GetProfiler() const { return m_profiler; } // nullptr unless the config enables profiling
+
+private:
+	Job* ClaimJobToExecute(int threadJobType, JobWorkerThread* workerThread, bool isWaitingThread = false, bool* out_wasStolen = nullptr);
+	Job* ClaimPriorityJob(JobPriority priority);
+	bool IsBackgroundWorkAllowed() const;
+	bool IsBackgroundQueueStarving() const;
+	JobWorkerThread* GetCurrentWorkerThread() const;
+	Job* ClaimTypedJob(int threadJobType);
+	void PushTypedJob(Job* job);
+	void UpdateSubscribedTypeBits();
+	Job* ClaimInjectedJob(JobWorkerThread* workerThread);
+	Job* StealJob(JobWorkerThread* thiefThread);
+	Job* ClaimJobOrPark(JobWorkerThread* workerThread, bool* out_wasStolen);
+	void ExecuteJob(Job* job, JobWorkerThread* workerThread, bool wasStolen);
+	bool IsProfiling() const;
+	void EnqueueJob(Job* job);
+	void WakeWorkerThreads(bool wakeAllWorkers);
+	template<typename T_Predicate>
+	bool WaitUntil(T_Predicate isWaitOver, bool executeJobsWhileWaiting, double timeoutSeconds = -1.0);
+	void SignalCounter(JobCounter& counter, std::vector<Job*>* out_droppedContinuations = nullptr); // Continuations go to out_droppedContinuations instead of the queues when given
+	void PushCompletedJob(Job* job);
+	void TakeCompletedJobs();
+	bool ReleaseOwnedJob(Job* job); // Destroys pooled and self deleting jobs, false if the job belongs to the caller
+	int GetTypedQueueIndex(int jobType) const;
+	void AssignWorkerCores();
 
 private:
 	JobSystemConfig m_config;
 
-	std::deque<Job*> m_queuedJobs;
+	std::deque<Job*> m_queuedJobs; // Multipurpose jobs queued from outside the worker threads
 	std::mutex m_queuedJobsMutex;
+	std::atomic<int> m_amountOfInjectedJobs = 0;
+
+	TypedJobQueue m_typedQueuedJobs[MAX_JOB_TYPE_BITS];
+	std::atomic<unsigned int> m_queuedTypeBits = 0; // Bit set while that bit's queue has jobs, changed under the queue's mutex
+	std::atomic<unsigned int> m_subscribedTypeBits = 0; // Every bit at least one worker takes
+	std::shared_mutex m_threadJobTypesMutex; // Shared while routing a typed job, exclusive while subscriptions change
+	PriorityJobQueue m_priorityQueuedJobs[(int)JobPriority::NUM_JOB_PRIORITIES]; // The NORMAL one stays empty
+	std::atomic<int> m_amountOfCriticalJobsInFlight = 0; // Queued or executing
+	std::atomic<double> m_frameDeadline = 0.0;
 
-	std::vector<Job*> m_jobsOnExecution;
-	std::mutex m_jobsOnExecutionMutex;
+	JobPool m_jobPool;
+	JobProfiler* m_profiler = nullptr; // Created in Startup (before any worker runs) and deleted in Shutdown (after every worker is joined)
 
-	std::deque<Job*> m_completedJobs;
-	std::mutex m_completedJobsMutex;
+	// Workers push completed jobs onto a lock-free list (newest first), the retrieving thread takes all of them with one exchange
+	alignas(64) std::atomic<Job*> m_completedJobsHead = nullptr;
+	alignas(64) Job* m_retrievedCompletedJobs = nullptr; // Already taken from the list and put back in completion order, only the retrieving thread touches it
 
 	std::vector<JobWorkerThread*> m_workerThreads;
 	std::atomic<int> m_amountOfExecutingJobs = 0; // Keeps track of current running jobs without having to use mutex + for loop for checking
 	std::atomic<int> m_amountOfQueuedJobs = 0; // Keeps track of current running jobs without having to use mutex + for loop for checking
+	std::atomic<int> m_amountOfWaitingJobs = 0; // Jobs that still have unfinished dependencies
+
+	// Idle workers sleep on the condition variable, every queued job bumps the epoch so a worker can't miss it
+	std::mutex m_parkingMutex;
+	std::condition_variable m_parkingCondition;
+	std::atomic<unsigned int> m_wakeEpoch = 0;
+	std::atomic<int> m_amountOfParkedWorkers = 0;
+
+	// Threads inside WaitUntil* sleep here, jobs only notify when someone is actually waiting
+	std::mutex m_waitingMutex;
+	std::condition_variable m_waitingCondition;
+	std::atomic<int> m_amountOfWaitingThreads = 0;
+	unsigned int m_waitingEpoch = 0; // Guarded by m_waitingMutex, bumped on every notification so waiters wake up to help or re-check
 
 };
 
+#pragma warning(pop)
+
 class Job {
 
 public:
@@ -66,26 +206,95 @@ public:
 
 	friend class JobWorkerThread;
 	friend class JobSystem;
-	
+
+public:
+	void SetCancellationToken(JobCancellationToken const* cancellationToken) { m_cancellationToken = cancellationToken; } // Before queuing it, the token has to outlive the job
+	bool IsCancelled() const;
+	bool WasStolen() const { return m_wasStolen; } // While executing: taken from another worker's own queue, not from a shared one
+
 public:
 	std::atomic<int> m_jobType = -1;
+	JobPriority m_priority = JobPriority::NORMAL; // Ignored by jobs with type bits, those always go to their type's queue
 
 protected:
 	virtual void Execute() = 0;
 	virtual void OnFinished() = 0;
+	virtual void OnCancelled() {} // Runs instead of Execute + OnFinished when the token got cancelled before the job started
 
 protected:
-	int m_executionId = -1;
+	bool m_isExecuting = false; // Set while claimed, completing a job that never got claimed does nothing
+	Job* m_nextCompletedJob = nullptr;
+	bool m_deleteOnCompletion = false; // Jobs the system creates for itself delete themselves instead of going to the completed queue
+	int m_poolBlockIndex = -1; // Jobs living in the JobSystem's pool go back to it once completed
+	double m_queuedTime = 0.0;
+	JobCounter* m_completionCounter = nullptr; // Signaled once this job finishes
+	JobCancellationToken const* m_cancellationToken = nullptr;
+	std::atomic<int> m_amountOfPendingDependencies = 0;
+	bool m_wasStolen = false;
+
+};
+
+// Catches the Job base growing into the room pooled jobs count on for their captures
+static_assert(sizeof(Job) + JOB_POOL_MIN_CAPTURE_BYTES <= JOB_POOL_BLOCK_SIZE, "Job base is too big for JOB_POOL_BLOCK_SIZE, raise the block size");
 
+// Runs a callable. The captures live inside the job, and the job lives inside a pool block, so small lambdas need no allocations
+template<typename T_Function>
+class LambdaJob : public Job {
+public:
+	template<typename T_FunctionArg>
+	LambdaJob(T_FunctionArg&& function, int jobType) :
+		Job(jobType),
+		m_function(std::forward<T_FunctionArg>(function)) {}
 
+protected:
+	virtual void Execute() override { m_function(); }
+	virtual void OnFinished() override {}
+
+private:
+	T_Function m_function;
+};
+
+// Counts unfinished jobs. Jobs queued with QueueJobAfter are held by the counter and queued once it reaches 0,
+// so a frame can be expressed as a graph of jobs instead of waiting for everything between stages
+class JobCounter {
+	friend class JobSystem;
+
+public:
+	JobCounter() = default;
+	JobCounter(JobCounter const& copy) = delete;
+
+	int GetValue() const { return m_value.load(); }
+	bool IsComplete() const { return m_value.load() == 0; }
+
+private:
+	std::atomic<int> m_value = 0;
+	mutable std::mutex m_continuationsMutex;
+	std::vector<Job*> m_continuations;
+};
+
+// Marks a group of jobs as abandoned (e.g. everything loading a level that's being unloaded). Long jobs can poll IsCancelled
+// and bail out early, jobs that haven't started yet get skipped
+class JobCancellationToken {
+	friend class JobSystem;
+
+public:
+	JobCancellationToken() = default;
+	JobCancellationToken(JobCancellationToken const& copy) = delete;
+
+	bool IsCancelled() const { return m_isCancelled.load(std::memory_order_acquire); }
+	void Reset() { m_isCancelled = false; } // Only once nothing holding the token is queued anymore
+
+private:
+	std::atomic<bool> m_isCancelled = false;
 };
 
 class JobWorkerThread {
 
 public:
 	JobWorkerThread(JobSystem* jobSystem, int threadID);
-	~JobWorkerThread() {};
+	~JobWorkerThread();
 
+	void StartThread();
 	void WorkerThreadMain();
 	void JoinAndDeleteThread();
 
@@ -95,6 +304,48 @@ private:
 	std::atomic<bool> m_isQuitting = false;
 	int	m_threadID = -1;
 	std::thread* m_thread = nullptr;
-	int m_threadJobType = MULTIPURPOSE_THREAD; // 0 == Multipurpose as well as all 1s
+	std::atomic<int> m_threadJobType = MULTIPURPOSE_THREAD; // Type bits the worker subscribes to, all 1s takes everything. 0 takes nothing
+	int m_spinBudget = 0; // Adapts between a fraction of the configured spin count and the full count, depending on whether spinning finds work
+	WorkStealingDeque* m_localJobs = nullptr; // Multipurpose jobs queued by this worker, other workers steal from it
+	int m_logicalCoreId = -1; // Core the worker pins itself to, -1 lets the OS move it around
+	std::vector<int> m_stealOrder; // Other workers, closest cores first. Empty when workers aren't pinned
+};
+
+template<typename T_Job, typename... T_Args>
+T_Job* JobSystem::CreatePooledJob(T_Args&&... args)
+{
+	static_assert(std::is_base_of<Job, T_Job>::value, "Pooled jobs have to derive from Job");
+
+	if constexpr ((sizeof(T_Job) <= JOB_POOL_BLOCK_SIZE) && (alignof(T_Job) <= JOB_POOL_BLOCK_ALIGNMENT)) {
+		int blockIndex = m_jobPool.Allocate();
+		if (blockIndex >= 0) {
+			T_Job* pooledJob = new (m_jobPool.GetBlock(blockIndex)) T_Job(std::forward<T_Args>(args)...);
+			pooledJob->m_poolBlockIndex = blockIndex;
+			return pooledJob;
+		}
+	}
+
+	// Too big for a block (or the pool is full), still owned by the JobSystem
+	m_jobPool.AddHeapFallbackAllocation();
+	T_Job* heapJob = new T_Job(std::forward<T_Args>(args)...);
+	heapJob->m_deleteOnCompletion = true;
+	return heapJob;
+}
+
+template<typename T_Function>
+void JobSystem::QueueLambdaJob(T_Function&& function, JobCounter* completionCounter, int jobType, JobPriority priority)
+{
+	typedef LambdaJob<std::decay_t<T_Function>> T_LambdaJob;
+	T_LambdaJob* lambdaJob = CreatePooledJob<T_LambdaJob>(std::forward<T_Function>(function), jobType);
+	lambdaJob->m_priority = priority;
+	QueueJob(lambdaJob, completionCounter);
+}
 
-};
\ No newline at end of file
+template<typename T_Function>
+void JobSystem::QueueLambdaJobAfter(T_Function&& function, JobCounter& dependency, JobCounter* completionCounter, int jobType, JobPriority priority)
+{
+	typedef LambdaJob<std::decay_t<T_Function>> T_LambdaJob;
+	T_LambdaJob* lambdaJob = CreatePooledJob<T_LambdaJob>(std::forward<T_Function>(function), jobType);
+	lambdaJob->m_priority = priority;
+	QueueJobAfter(lambdaJob, dependency, completionCounter);
+}
@@ -0,0 +1,664 @@
+#include "Engine/Core/JobSystemBenchmark.hpp"
+#include "Engine/Core/AsyncFileIO.hpp"
+#include "Engine/Core/CpuTopology.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/JobSystemStressTest.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <math.h>
+#include <ctime>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#endif
+
+constexpr int TINY_JOB_ITERATIONS = 16;
+constexpr int LARGE_JOB_ITERATIONS = 50'000;
+constexpr double IDLE_MEASUREMENT_SECONDS = 0.25;
+constexpr int WAKE_LATENCY_SAMPLES = 100;
+constexpr int PRIORITY_BENCHMARK_FRAMES = 120;
+constexpr int FRAME_JOBS_PER_FRAME = 32;
+constexpr int BACKGROUND_JOBS_PER_THREAD = 4;
+constexpr int BACKGROUND_SLICES_PER_JOB = 200;
+constexpr int BACKGROUND_SLICE_ITERATIONS = 20'000;
+constexpr double PRIORITY_BENCHMARK_FRAME_BUDGET_SECONDS = 1.0 / 60.0;
+constexpr char const* FILE_IO_BENCHMARK_FOLDER = "Saved/FileIOBenchmark";
+constexpr int MAX_BENCHMARK_THREADS = 256;
+constexpr int MAX_BENCHMARK_JOBS = 10'000'000;
+constexpr int MAX_BENCHMARK_FILES = 100'000;
+constexpr int MAX_BENCHMARK_FILE_KILOBYTES = 1024 * 1024;
+
+class BenchmarkJob : public Job {
+public:
+	BenchmarkJob(int amountOfIterations) :
+		Job(DEFAULT_JOB_ID),
+		m_amountOfIterations(amountOfIterations) {}
+
+	float m_result = 0.0f;
+
+protected:
+	virtual void Execute() override {
+		float accumulatedValue = 0.0f;
+		for (int iteration = 0; iteration < m_amountOfIterations; iteration++) {
+			accumulatedValue += sqrtf(static_cast<float>(iteration)) * 0.5f;
+		}
+		m_result = accumulatedValue;
+	}
+	virtual void OnFinished() override {}
+
+private:
+	int m_amountOfIterations = 0;
+};
+
+class TimestampJob : public Job {
+public:
+	TimestampJob() :
+		Job(DEFAULT_JOB_ID) {}
+
+	double m_executionStartTime = 0.0;
+
+protected:
+	virtual void Execute() override { m_executionStartTime = GetCurrentTimeSeconds(); }
+	virtual void OnFinished() override {}
+};
+
+static double GetProcessCpuTimeSeconds()
+{
+#if defined(_WIN32)
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+	ULARGE_INTEGER kernelTicks, userTicks;
+	kernelTicks.LowPart = kernelTime.dwLowDateTime;
+	kernelTicks.HighPart = kernelTime.dwHighDateTime;
+	userTicks.LowPart = userTime.dwLowDateTime;
+	userTicks.HighPart = userTime.dwHighDateTime;
+	return static_cast<double>(kernelTicks.QuadPart + userTicks.QuadPart) * 100e-9; // FILETIME ticks are 100ns
+#else
+	return static_cast<double>(std::clock()) / static_cast<double>(CLOCKS_PER_SEC);
+#endif
+}
+
+double JobSystemBenchmarkResult::GetNanosecondsPerJob() const
+{
+	if (m_amountOfJobs <= 0) return 0.0;
+	return (m_elapsedSeconds * 1'000'000'000.0) / static_cast<double>(m_amountOfJobs);
+}
+
+double JobSystemBenchmarkResult::GetJobsPerSecond() const
+{
+	if (m_elapsedSeconds <= 0.0) return 0.0;
+	return static_cast<double>(m_amountOfJobs) / m_elapsedSeconds;
+}
+
+static double MeasureJobThroughput(JobSystemConfig const& jobSystemConfig, std::vector<BenchmarkJob*> const& jobs)
+{
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < jobs.size(); jobIndex++) {
+		jobSystem.QueueJob(jobs[jobIndex]);
+	}
+	jobSystem.WaitUntilQueuedJobsCompletion();
+	double elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	jobSystem.ClearCompletedJobs();
+	jobSystem.Shutdown();
+
+	return elapsedSeconds;
+}
+
+static void RunScalingScenario(JobSystemBenchmarkResults& out_results, char const* scenarioName, int jobIterations, int maxThreads, int amountOfJobs, bool pinWorkerThreads = false)
+{
+	std::vector<BenchmarkJob*> jobs;
+	jobs.reserve(amountOfJobs);
+	for (int jobIndex = 0; jobIndex < amountOfJobs; jobIndex++) {
+		jobs.push_back(new BenchmarkJob(jobIterations));
+	}
+
+	std::vector<int> threadCounts;
+	for (int amountOfThreads = 1; amountOfThreads < maxThreads; amountOfThreads *= 2) {
+		threadCounts.push_back(amountOfThreads);
+	}
+	threadCounts.push_back(maxThreads); // Always measure the full core count, even if it's not a power of 2
+
+	for (int countIndex = 0; countIndex < threadCounts.size(); countIndex++) {
+		JobSystemBenchmarkResult result;
+		result.m_scenarioName = scenarioName;
+		result.m_amountOfThreads = threadCounts[countIndex];
+		result.m_amountOfJobs = amountOfJobs;
+
+		JobSystemConfig jobSystemConfig;
+		jobSystemConfig.m_amountOfThreads = threadCounts[countIndex];
+		jobSystemConfig.m_pinWorkerThreads = pinWorkerThreads;
+		jobSystemConfig.m_executeJobsWhileWaiting = false; // A helping main thread would make every row one thread more than it says
+		result.m_elapsedSeconds = MeasureJobThroughput(jobSystemConfig, jobs);
+		out_results.push_back(result);
+	}
+
+	for (int jobIndex = 0; jobIndex < jobs.size(); jobIndex++) {
+		delete jobs[jobIndex];
+	}
+}
+
+void RunJobSystemScalingBenchmark(JobSystemBenchmarkResults& out_results, int maxThreads, int amountOfJobs)
+{
+	if (maxThreads <= 0) {
+		maxThreads = (int)std::thread::hardware_concurrency();
+	}
+	if (maxThreads <= 0) {
+		maxThreads = 1;
+	}
+
+	RunScalingScenario(out_results, "TinyJobs", TINY_JOB_ITERATIONS, maxThreads, amountOfJobs);
+	RunScalingScenario(out_results, "LargeJobs", LARGE_JOB_ITERATIONS, maxThreads, amountOfJobs / 100 + 1);
+}
+
+void RunJobSystemAffinityBenchmark(JobSystemBenchmarkResults& out_results, int maxThreads, int amountOfJobs)
+{
+	if (maxThreads <= 0) {
+		maxThreads = (int)std::thread::hardware_concurrency();
+	}
+	if (maxThreads <= 0) {
+		maxThreads = 1;
+	}
+
+	RunScalingScenario(out_results, "TinyJobs", TINY_JOB_ITERATIONS, maxThreads, amountOfJobs, false);
+	RunScalingScenario(out_results, "TinyJobsPinned", TINY_JOB_ITERATIONS, maxThreads, amountOfJobs, true);
+	RunScalingScenario(out_results, "LargeJobs", LARGE_JOB_ITERATIONS, maxThreads, amountOfJobs / 100 + 1, false);
+	RunScalingScenario(out_results, "LargeJobsPinned", LARGE_JOB_ITERATIONS, maxThreads, amountOfJobs / 100 + 1, true);
+}
+
+static JobSystemIdleBenchmarkResult MeasureIdleBehaviour(int amountOfThreads, int spinCountBeforeParking)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	jobSystemConfig.m_spinCountBeforeParking = spinCountBeforeParking;
+	jobSystemConfig.m_executeJobsWhileWaiting = false; // The injected job has to wake a parked worker, not get claimed by the waiting thread
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	JobSystemIdleBenchmarkResult result;
+	result.m_amountOfThreads = amountOfThreads;
+	result.m_spinCountBeforeParking = spinCountBeforeParking;
+
+	// The calling thread sleeps, so any CPU time spent in between belongs to the idle workers
+	double cpuTimeBefore = GetProcessCpuTimeSeconds();
+	double wallTimeBefore = GetCurrentTimeSeconds();
+	std::this_thread::sleep_for(std::chrono::duration<double>(IDLE_MEASUREMENT_SECONDS));
+	double cpuSeconds = GetProcessCpuTimeSeconds() - cpuTimeBefore;
+	double wallSeconds = GetCurrentTimeSeconds() - wallTimeBefore;
+	result.m_idleCpuPercentage = (wallSeconds > 0.0) ? (cpuSeconds / wallSeconds) * 100.0 : 0.0;
+
+	TimestampJob timestampJob;
+	double totalLatency = 0.0;
+	for (int sampleIndex = 0; sampleIndex < WAKE_LATENCY_SAMPLES; sampleIndex++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(2)); // Long enough for the workers to run out of spins
+
+		double queueTime = GetCurrentTimeSeconds();
+		jobSystem.QueueJob(&timestampJob);
+		jobSystem.WaitUntilQueuedJobsCompletion();
+		jobSystem.ClearCompletedJobs();
+
+		double latency = timestampJob.m_executionStartTime - queueTime;
+		totalLatency += latency;
+		if (latency > result.m_maxWakeLatencyMicroseconds * 1e-6) {
+			result.m_maxWakeLatencyMicroseconds = latency * 1e6;
+		}
+	}
+	result.m_averageWakeLatencyMicroseconds = (totalLatency / static_cast<double>(WAKE_LATENCY_SAMPLES)) * 1e6;
+
+	jobSystem.Shutdown();
+	return result;
+}
+
+void RunJobSystemIdleBenchmark(JobSystemIdleBenchmarkResults& out_results, int amountOfThreads)
+{
+	if (amountOfThreads <= 0) {
+		amountOfThreads = (int)std::thread::hardware_concurrency();
+	}
+	if (amountOfThreads <= 0) {
+		amountOfThreads = 1;
+	}
+
+	JobSystemConfig defaultConfig;
+	out_results.push_back(MeasureIdleBehaviour(amountOfThreads, 0));
+	out_results.push_back(MeasureIdleBehaviour(amountOfThreads, defaultConfig.m_spinCountBeforeParking));
+	out_results.push_back(MeasureIdleBehaviour(amountOfThreads, defaultConfig.m_spinCountBeforeParking * 64));
+}
+
+static double RunHeapJobsFrame(JobSystem& jobSystem, int amountOfJobs)
+{
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < amountOfJobs; jobIndex++) {
+		jobSystem.QueueJob(new BenchmarkJob(TINY_JOB_ITERATIONS));
+	}
+	jobSystem.WaitUntilQueuedJobsCompletion();
+
+	Job* completedJobs[256];
+	for (int amountOfCompletedJobs = jobSystem.RetrieveCompletedJobs(completedJobs, 256); amountOfCompletedJobs > 0; amountOfCompletedJobs = jobSystem.RetrieveCompletedJobs(completedJobs, 256)) {
+		for (int completedJobIndex = 0; completedJobIndex < amountOfCompletedJobs; completedJobIndex++) {
+			delete completedJobs[completedJobIndex];
+		}
+	}
+	return GetCurrentTimeSeconds() - startTime;
+}
+
+static double RunLambdaJobsFrame(JobSystem& jobSystem, int amountOfJobs, std::vector<float>& results)
+{
+	double startTime = GetCurrentTimeSeconds();
+	JobCounter frameCounter;
+	for (int jobIndex = 0; jobIndex < amountOfJobs; jobIndex++) {
+		float* result = &results[jobIndex];
+		jobSystem.QueueLambdaJob([result]() {
+			float accumulatedValue = 0.0f;
+			for (int iteration = 0; iteration < TINY_JOB_ITERATIONS; iteration++) {
+				accumulatedValue += sqrtf(static_cast<float>(iteration)) * 0.5f;
+			}
+			*result = accumulatedValue;
+		}, &frameCounter);
+	}
+	jobSystem.WaitUntilCounterCompletion(frameCounter);
+	return GetCurrentTimeSeconds() - startTime;
+}
+
+void RunJobSystemAllocationBenchmark(JobSystemAllocationBenchmarkResults& out_results, int amountOfThreads, int amountOfJobs)
+{
+	if (amountOfThreads <= 0) {
+		amountOfThreads = (int)std::thread::hardware_concurrency();
+	}
+	if (amountOfThreads <= 0) {
+		amountOfThreads = 1;
+	}
+
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	// Every heap job is a new + delete, there's nothing to warm up
+	JobSystemAllocationBenchmarkResult heapResult;
+	heapResult.m_scenarioName = "HeapJobs";
+	heapResult.m_amountOfThreads = amountOfThreads;
+	heapResult.m_amountOfJobs = amountOfJobs;
+	heapResult.m_elapsedSeconds = RunHeapJobsFrame(jobSystem, amountOfJobs);
+	heapResult.m_amountOfHeapAllocations = amountOfJobs;
+	out_results.push_back(heapResult);
+
+	std::vector<float> lambdaResults(amountOfJobs);
+	RunLambdaJobsFrame(jobSystem, amountOfJobs, lambdaResults);
+	int heapAllocationsBefore = jobSystem.GetAmountOfJobHeapAllocations();
+
+	JobSystemAllocationBenchmarkResult lambdaResult;
+	lambdaResult.m_scenarioName = "PooledLambdaJobs";
+	lambdaResult.m_amountOfThreads = amountOfThreads;
+	lambdaResult.m_amountOfJobs = amountOfJobs;
+	lambdaResult.m_elapsedSeconds = RunLambdaJobsFrame(jobSystem, amountOfJobs, lambdaResults);
+	lambdaResult.m_amountOfHeapAllocations = jobSystem.GetAmountOfJobHeapAllocations() - heapAllocationsBefore;
+	out_results.push_back(lambdaResult);
+
+	jobSystem.Shutdown();
+}
+
+static float RunBenchmarkIterations(int amountOfIterations)
+{
+	float accumulatedValue = 0.0f;
+	for (int iteration = 0; iteration < amountOfIterations; iteration++) {
+		accumulatedValue += sqrtf(static_cast<float>(iteration)) * 0.5f;
+	}
+	return accumulatedValue;
+}
+
+// Long running work split in slices. Background priority work checks between slices whether it should make room for the frame
+static void QueueLongRunningWork(JobSystem& jobSystem, int amountOfSlices, bool useBackgroundPriority, std::atomic<bool>* isStopRequested)
+{
+	JobSystem* jobSystemPtr = &jobSystem;
+	JobPriority priority = (useBackgroundPriority) ? JobPriority::BACKGROUND : JobPriority::NORMAL;
+
+	jobSystem.QueueLambdaJob([jobSystemPtr, amountOfSlices, useBackgroundPriority, isStopRequested]() {
+		for (int sliceIndex = 0; sliceIndex < amountOfSlices; sliceIndex++) {
+			if (*isStopRequested) return;
+			RunBenchmarkIterations(BACKGROUND_SLICE_ITERATIONS);
+
+			int remainingSlices = amountOfSlices - sliceIndex - 1;
+			if (useBackgroundPriority && (remainingSlices > 0) && jobSystemPtr->ShouldBackgroundJobsYield()) {
+				QueueLongRunningWork(*jobSystemPtr, remainingSlices, useBackgroundPriority, isStopRequested);
+				return;
+			}
+		}
+	}, nullptr, DEFAULT_JOB_ID, priority);
+}
+
+static JobSystemPriorityBenchmarkResult MeasureFrameTimesUnderLoad(char const* scenarioName, int amountOfThreads, bool usePriorities)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	jobSystemConfig.m_frameBudgetSeconds = (usePriorities) ? PRIORITY_BENCHMARK_FRAME_BUDGET_SECONDS : 0.0;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	std::atomic<bool> isStopRequested = false;
+	for (int jobIndex = 0; jobIndex < amountOfThreads * BACKGROUND_JOBS_PER_THREAD; jobIndex++) {
+		QueueLongRunningWork(jobSystem, BACKGROUND_SLICES_PER_JOB, usePriorities, &isStopRequested);
+	}
+
+	JobPriority framePriority = (usePriorities) ? JobPriority::CRITICAL : JobPriority::NORMAL;
+	std::vector<double> frameTimes;
+	frameTimes.reserve(PRIORITY_BENCHMARK_FRAMES);
+
+	for (int frameIndex = 0; frameIndex < PRIORITY_BENCHMARK_FRAMES; frameIndex++) {
+		jobSystem.BeginFrame();
+		double frameStartTime = GetCurrentTimeSeconds();
+
+		JobCounter frameCounter;
+		for (int jobIndex = 0; jobIndex < FRAME_JOBS_PER_FRAME; jobIndex++) {
+			jobSystem.QueueLambdaJob([]() { RunBenchmarkIterations(TINY_JOB_ITERATIONS); }, &frameCounter, DEFAULT_JOB_ID, framePriority);
+		}
+		jobSystem.WaitUntilCounterCompletion(frameCounter);
+
+		frameTimes.push_back((GetCurrentTimeSeconds() - frameStartTime) * 1000.0);
+		jobSystem.EndFrame();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Stands in for the rest of the frame, lets long running work grab the workers again
+	}
+
+	isStopRequested = true;
+	jobSystem.WaitUntilQueuedJobsCompletion();
+	jobSystem.Shutdown();
+
+	JobSystemPriorityBenchmarkResult result;
+	result.m_scenarioName = scenarioName;
+	result.m_amountOfThreads = amountOfThreads;
+	result.m_amountOfFrames = PRIORITY_BENCHMARK_FRAMES;
+
+	double totalFrameTime = 0.0;
+	for (int frameIndex = 0; frameIndex < frameTimes.size(); frameIndex++) {
+		totalFrameTime += frameTimes[frameIndex];
+	}
+	result.m_averageFrameMilliseconds = totalFrameTime / static_cast<double>(frameTimes.size());
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+	result.m_p99FrameMilliseconds = frameTimes[(frameTimes.size() * 99) / 100];
+	result.m_maxFrameMilliseconds = frameTimes.back();
+	return result;
+}
+
+void RunJobSystemPriorityBenchmark(JobSystemPriorityBenchmarkResults& out_results, int amountOfThreads)
+{
+	if (amountOfThreads <= 0) {
+		amountOfThreads = (int)std::thread::hardware_concurrency();
+	}
+	if (amountOfThreads <= 0) {
+		amountOfThreads = 1;
+	}
+
+	out_results.push_back(MeasureFrameTimesUnderLoad("SinglePriority", amountOfThreads, false));
+	out_results.push_back(MeasureFrameTimesUnderLoad("Prioritized", amountOfThreads, true));
+}
+
+static void CreateFileIOBenchmarkFiles(std::vector<std::string>& out_filePaths, int amountOfFiles, int fileSizeKilobytes)
+{
+	std::filesystem::create_directories(FILE_IO_BENCHMARK_FOLDER);
+
+	std::vector<uint8_t> fileData(static_cast<size_t>(fileSizeKilobytes) * 1024);
+	for (int fileIndex = 0; fileIndex < amountOfFiles; fileIndex++) {
+		for (size_t byteIndex = 0; byteIndex < fileData.size(); byteIndex++) {
+			fileData[byteIndex] = static_cast<uint8_t>(byteIndex * 31 + fileIndex);
+		}
+
+		std::string filePath = Stringf("%s/Asset%04d.bin", FILE_IO_BENCHMARK_FOLDER, fileIndex);
+		FileWriteFromBuffer(fileData, filePath);
+		out_filePaths.push_back(filePath);
+	}
+}
+
+static FileIOBenchmarkResult MeasureAsyncFileLoads(char const* scenarioName, JobSystem& jobSystem, std::vector<std::string> const& filePaths, int amountOfThreads, bool useIoUring)
+{
+	AsyncFileIOConfig fileIOConfig;
+	fileIOConfig.m_jobSystem = &jobSystem;
+	fileIOConfig.m_amountOfThreads = amountOfThreads;
+	fileIOConfig.m_useIoUring = useIoUring;
+	AsyncFileIO fileIO(fileIOConfig);
+	fileIO.Startup();
+
+	FileIOBenchmarkResult result;
+	result.m_scenarioName = scenarioName;
+	result.m_amountOfThreads = (fileIO.IsUsingIoUring()) ? 1 : amountOfThreads;
+	result.m_amountOfFiles = (int)filePaths.size();
+
+	// Thread pool fallback on kernels without io_uring, it would only repeat the thread pool scenario
+	if (useIoUring && !fileIO.IsUsingIoUring()) {
+		fileIO.Shutdown();
+		result.m_amountOfFiles = 0;
+		return result;
+	}
+
+	std::vector<FileReadRequest> requests(filePaths.size());
+	for (int fileIndex = 0; fileIndex < filePaths.size(); fileIndex++) {
+		requests[fileIndex].m_filePath = filePaths[fileIndex];
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	JobCounter loadedCounter;
+	fileIO.ReadFiles(requests.data(), (int)requests.size(), &loadedCounter);
+	jobSystem.WaitUntilCounterCompletion(loadedCounter);
+	result.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	for (int fileIndex = 0; fileIndex < requests.size(); fileIndex++) {
+		result.m_totalBytes += requests[fileIndex].m_data.size();
+		if (!requests[fileIndex].IsSuccessful()) result.m_amountOfFailedReads++;
+	}
+
+	fileIO.Shutdown();
+	return result;
+}
+
+void RunFileIOBenchmark(FileIOBenchmarkResults& out_results, int amountOfThreads, int amountOfFiles, int fileSizeKilobytes)
+{
+	if (amountOfThreads <= 0) {
+		amountOfThreads = (int)std::thread::hardware_concurrency();
+	}
+	if (amountOfThreads <= 0) {
+		amountOfThreads = 1;
+	}
+
+	std::vector<std::string> filePaths;
+	CreateFileIOBenchmarkFiles(filePaths, amountOfFiles, fileSizeKilobytes);
+
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	// What FileReadToBuffer does today, one file after the other on the calling thread
+	FileIOBenchmarkResult synchronousResult;
+	synchronousResult.m_scenarioName = "Synchronous";
+	synchronousResult.m_amountOfThreads = 1;
+	synchronousResult.m_amountOfFiles = amountOfFiles;
+	double startTime = GetCurrentTimeSeconds();
+	for (int fileIndex = 0; fileIndex < amountOfFiles; fileIndex++) {
+		std::vector<uint8_t> fileData;
+		if (!ReadFileBlocking(filePaths[fileIndex], fileData)) synchronousResult.m_amountOfFailedReads++;
+		synchronousResult.m_totalBytes += fileData.size();
+	}
+	synchronousResult.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+	out_results.push_back(synchronousResult);
+
+	// A loading job per file, every worker blocks on the disk while it reads
+	FileIOBenchmarkResult blockingJobsResult;
+	blockingJobsResult.m_scenarioName = "BlockingJobs";
+	blockingJobsResult.m_amountOfThreads = amountOfThreads;
+	blockingJobsResult.m_amountOfFiles = amountOfFiles;
+	std::vector<std::vector<uint8_t>> filesData(amountOfFiles);
+	std::atomic<int> amountOfFailedReads = 0;
+	startTime = GetCurrentTimeSeconds();
+	JobCounter loadedCounter;
+	for (int fileIndex = 0; fileIndex < amountOfFiles; fileIndex++) {
+		std::string const* filePath = &filePaths[fileIndex];
+		std::vector<uint8_t>* fileData = &filesData[fileIndex];
+		jobSystem.QueueLambdaJob([filePath, fileData, &amountOfFailedReads]() {
+			if (!ReadFileBlocking(*filePath, *fileData)) amountOfFailedReads++;
+		}, &loadedCounter);
+	}
+	jobSystem.WaitUntilCounterCompletion(loadedCounter);
+	blockingJobsResult.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+	for (int fileIndex = 0; fileIndex < amountOfFiles; fileIndex++) {
+		blockingJobsResult.m_totalBytes += filesData[fileIndex].size();
+	}
+	blockingJobsResult.m_amountOfFailedReads = amountOfFailedReads.load();
+	out_results.push_back(blockingJobsResult);
+
+	out_results.push_back(MeasureAsyncFileLoads("AsyncThreadPool", jobSystem, filePaths, amountOfThreads, false));
+	FileIOBenchmarkResult ioUringResult = MeasureAsyncFileLoads("AsyncIoUring", jobSystem, filePaths, amountOfThreads, true);
+	if (ioUringResult.m_amountOfFiles > 0) {
+		out_results.push_back(ioUringResult);
+	}
+
+	jobSystem.Shutdown();
+	std::error_code removeError;
+	std::filesystem::remove_all(FILE_IO_BENCHMARK_FOLDER, removeError);
+}
+
+void GetCpuTopologyReport(std::vector<std::string>& out_reportLines)
+{
+	CpuTopology cpuTopology;
+	bool isDetected = cpuTopology.Detect();
+
+	std::vector<int> l3CacheIds;
+	std::vector<int> numaNodeIds;
+	for (int coreIndex = 0; coreIndex < cpuTopology.GetAmountOfLogicalCores(); coreIndex++) {
+		LogicalCoreInfo const& coreInfo = cpuTopology.GetLogicalCore(coreIndex);
+		if (std::find(l3CacheIds.begin(), l3CacheIds.end(), coreInfo.m_l3CacheId) == l3CacheIds.end()) l3CacheIds.push_back(coreInfo.m_l3CacheId);
+		if (std::find(numaNodeIds.begin(), numaNodeIds.end(), coreInfo.m_numaNodeId) == numaNodeIds.end()) numaNodeIds.push_back(coreInfo.m_numaNodeId);
+	}
+
+	out_reportLines.push_back(Stringf("CPU topology%s: %d logical cores, %d physical cores, %d L3 caches, %d NUMA nodes",
+		(isDetected) ? "" : " (not detected, assuming no SMT)", cpuTopology.GetAmountOfLogicalCores(), cpuTopology.GetAmountOfPhysicalCores(), (int)l3CacheIds.size(), (int)numaNodeIds.size()));
+}
+
+void GetJobSystemBenchmarkReport(JobSystemBenchmarkResults const& results, std::vector<std::string>& out_reportLines)
+{
+	for (int resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+		JobSystemBenchmarkResult const& result = results[resultIndex];
+
+		double singleThreadSeconds = 0.0;
+		for (int otherIndex = 0; otherIndex < results.size(); otherIndex++) {
+			JobSystemBenchmarkResult const& otherResult = results[otherIndex];
+			if ((otherResult.m_amountOfThreads == 1) && (otherResult.m_scenarioName == result.m_scenarioName)) {
+				singleThreadSeconds = otherResult.m_elapsedSeconds;
+				break;
+			}
+		}
+
+		double speedUp = (result.m_elapsedSeconds > 0.0) ? singleThreadSeconds / result.m_elapsedSeconds : 0.0;
+		out_reportLines.push_back(Stringf("%-16s threads: %3d jobs: %8d %12.1f ns/job %14.0f jobs/s speedup: %.2fx",
+			result.m_scenarioName.c_str(), result.m_amountOfThreads, result.m_amountOfJobs, result.GetNanosecondsPerJob(), result.GetJobsPerSecond(), speedUp));
+	}
+}
+
+void GetJobSystemIdleBenchmarkReport(JobSystemIdleBenchmarkResults const& results, std::vector<std::string>& out_reportLines)
+{
+	for (int resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+		JobSystemIdleBenchmarkResult const& result = results[resultIndex];
+		out_reportLines.push_back(Stringf("Idle             threads: %3d spins: %6d idle cpu: %6.1f%% wake latency avg: %8.1f us max: %8.1f us",
+			result.m_amountOfThreads, result.m_spinCountBeforeParking, result.m_idleCpuPercentage, result.m_averageWakeLatencyMicroseconds, result.m_maxWakeLatencyMicroseconds));
+	}
+}
+
+void GetJobSystemAllocationBenchmarkReport(JobSystemAllocationBenchmarkResults const& results, std::vector<std::string>& out_reportLines)
+{
+	for (int resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+		JobSystemAllocationBenchmarkResult const& result = results[resultIndex];
+		double nanosecondsPerJob = (result.m_amountOfJobs > 0) ? (result.m_elapsedSeconds * 1'000'000'000.0) / static_cast<double>(result.m_amountOfJobs) : 0.0;
+		out_reportLines.push_back(Stringf("%-16s threads: %3d jobs: %8d %12.1f ns/job heap allocations: %8d",
+			result.m_scenarioName.c_str(), result.m_amountOfThreads, result.m_amountOfJobs, nanosecondsPerJob, result.m_amountOfHeapAllocations));
+	}
+}
+
+void GetJobSystemPriorityBenchmarkReport(JobSystemPriorityBenchmarkResults const& results, std::vector<std::string>& out_reportLines)
+{
+	for (int resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+		JobSystemPriorityBenchmarkResult const& result = results[resultIndex];
+		out_reportLines.push_back(Stringf("%-16s threads: %3d frames: %6d frame avg: %8.3f ms p99: %8.3f ms max: %8.3f ms",
+			result.m_scenarioName.c_str(), result.m_amountOfThreads, result.m_amountOfFrames, result.m_averageFrameMilliseconds, result.m_p99FrameMilliseconds, result.m_maxFrameMilliseconds));
+	}
+}
+
+void GetFileIOBenchmarkReport(FileIOBenchmarkResults const& results, std::vector<std::string>& out_reportLines)
+{
+	for (int resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+		FileIOBenchmarkResult const& result = results[resultIndex];
+		double megabytes = static_cast<double>(result.m_totalBytes) / (1024.0 * 1024.0);
+		double megabytesPerSecond = (result.m_elapsedSeconds > 0.0) ? megabytes / result.m_elapsedSeconds : 0.0;
+		out_reportLines.push_back(Stringf("%-16s threads: %3d files: %6d %10.3f ms %10.1f MB/s failed: %d",
+			result.m_scenarioName.c_str(), result.m_amountOfThreads, result.m_amountOfFiles, result.m_elapsedSeconds * 1000.0, megabytesPerSecond, result.m_amountOfFailedReads));
+	}
+}
+
+bool Command_JobSystemBenchmark(EventArgs& args)
+{
+	std::string threadsText = args.GetValue("threads", "");
+	std::string jobsText = args.GetValue("jobs", "");
+	std::string scenario = args.GetValue("scenario", "all");
+
+	int maxThreads = ParseClampedInt(threadsText, 0, 0, MAX_BENCHMARK_THREADS); // 0 uses every hardware thread
+	int amountOfJobs = ParseClampedInt(jobsText, 100'000, 1, MAX_BENCHMARK_JOBS);
+	bool runAllScenarios = AreStringsEqualCaseInsensitive(scenario, "all");
+
+	std::vector<std::string> reportLines;
+	if (runAllScenarios || AreStringsEqualCaseInsensitive(scenario, "scaling")) {
+		JobSystemBenchmarkResults results;
+		RunJobSystemScalingBenchmark(results, maxThreads, amountOfJobs);
+		GetJobSystemBenchmarkReport(results, reportLines);
+	}
+
+	if (runAllScenarios || AreStringsEqualCaseInsensitive(scenario, "affinity")) {
+		GetCpuTopologyReport(reportLines);
+		JobSystemBenchmarkResults affinityResults;
+		RunJobSystemAffinityBenchmark(affinityResults, maxThreads, amountOfJobs);
+		GetJobSystemBenchmarkReport(affinityResults, reportLines);
+	}
+
+	if (runAllScenarios || AreStringsEqualCaseInsensitive(scenario, "idle")) {
+		JobSystemIdleBenchmarkResults idleResults;
+		RunJobSystemIdleBenchmark(idleResults, maxThreads);
+		GetJobSystemIdleBenchmarkReport(idleResults, reportLines);
+	}
+
+	if (runAllScenarios || AreStringsEqualCaseInsensitive(scenario, "alloc")) {
+		JobSystemAllocationBenchmarkResults allocationResults;
+		RunJobSystemAllocationBenchmark(allocationResults, maxThreads, amountOfJobs);
+		GetJobSystemAllocationBenchmarkReport(allocationResults, reportLines);
+	}
+
+	if (runAllScenarios || AreStringsEqualCaseInsensitive(scenario, "priority")) {
+		JobSystemPriorityBenchmarkResults priorityResults;
+		RunJobSystemPriorityBenchmark(priorityResults, maxThreads);
+		GetJobSystemPriorityBenchmarkReport(priorityResults, reportLines);
+	}
+
+	if (runAllScenarios || AreStringsEqualCaseInsensitive(scenario, "stress")) {
+		std::string producersText = args.GetValue("producers", "");
+		int amountOfProducers = ParseClampedInt(producersText, 0, 0, MAX_BENCHMARK_THREADS);
+
+		JobSystemStressResults stressResults;
+		RunJobSystemStressTest(stressResults, maxThreads, amountOfJobs, amountOfProducers);
+		GetJobSystemStressTestReport(stressResults, reportLines);
+	}
+
+	// Not part of "all", it writes files
+	if (AreStringsEqualCaseInsensitive(scenario, "io")) {
+		std::string filesText = args.GetValue("files", "");
+		std::string fileSizeText = args.GetValue("fileKB", "");
+		int amountOfFiles = ParseClampedInt(filesText, 512, 1, MAX_BENCHMARK_FILES);
+		int fileSizeKilobytes = ParseClampedInt(fileSizeText, 64, 1, MAX_BENCHMARK_FILE_KILOBYTES);
+
+		FileIOBenchmarkResults fileIOResults;
+		RunFileIOBenchmark(fileIOResults, maxThreads, amountOfFiles, fileSizeKilobytes);
+		GetFileIOBenchmarkReport(fileIOResults, reportLines);
+	}
+
+	AddDevConsoleReportLines(reportLines);
+
+	return true;
+}
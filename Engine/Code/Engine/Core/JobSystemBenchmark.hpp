@@ -0,0 +1,77 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+#include <vector>
+
+// Headless JobSystem measurements: every scenario spins up its own JobSystem, so nothing else needs to be running
+struct JobSystemBenchmarkResult {
+	std::string m_scenarioName;
+	int m_amountOfThreads = 0;
+	int m_amountOfJobs = 0;
+	double m_elapsedSeconds = 0.0;
+
+	double GetNanosecondsPerJob() const;
+	double GetJobsPerSecond() const;
+};
+
+typedef std::vector<JobSystemBenchmarkResult> JobSystemBenchmarkResults;
+
+struct JobSystemIdleBenchmarkResult {
+	int m_amountOfThreads = 0;
+	int m_spinCountBeforeParking = 0;
+	double m_idleCpuPercentage = 0.0; // Of a single core, for the whole process while no jobs are queued
+	double m_averageWakeLatencyMicroseconds = 0.0; // From QueueJob on an idle system until the job starts executing
+	double m_maxWakeLatencyMicroseconds = 0.0;
+};
+
+typedef std::vector<JobSystemIdleBenchmarkResult> JobSystemIdleBenchmarkResults;
+
+// One "frame" worth of tiny jobs, measured after a warm-up frame so pools are already grown
+struct JobSystemAllocationBenchmarkResult {
+	std::string m_scenarioName;
+	int m_amountOfThreads = 0;
+	int m_amountOfJobs = 0;
+	double m_elapsedSeconds = 0.0;
+	int m_amountOfHeapAllocations = 0; // Job allocations done during the measured frame
+};
+
+typedef std::vector<JobSystemAllocationBenchmarkResult> JobSystemAllocationBenchmarkResults;
+
+// Frames of tiny jobs that the frame waits on, while long running jobs keep every worker busy
+struct JobSystemPriorityBenchmarkResult {
+	std::string m_scenarioName;
+	int m_amountOfThreads = 0;
+	int m_amountOfFrames = 0;
+	double m_averageFrameMilliseconds = 0.0;
+	double m_p99FrameMilliseconds = 0.0;
+	double m_maxFrameMilliseconds = 0.0;
+};
+
+typedef std::vector<JobSystemPriorityBenchmarkResult> JobSystemPriorityBenchmarkResults;
+
+// Loading a folder of generated asset files. They were just written, so this mostly measures dispatch and syscalls, not the disk
+struct FileIOBenchmarkResult {
+	std::string m_scenarioName;
+	int m_amountOfThreads = 0;
+	int m_amountOfFiles = 0;
+	size_t m_totalBytes = 0;
+	double m_elapsedSeconds = 0.0;
+	int m_amountOfFailedReads = 0;
+};
+
+typedef std::vector<FileIOBenchmarkResult> FileIOBenchmarkResults;
+
+void RunJobSystemScalingBenchmark(JobSystemBenchmarkResults& out_results, int maxThreads, int amountOfJobs);
+void RunJobSystemAffinityBenchmark(JobSystemBenchmarkResults& out_results, int maxThreads, int amountOfJobs);
+void RunJobSystemIdleBenchmark(JobSystemIdleBenchmarkResults& out_results, int amountOfThreads);
+void RunJobSystemAllocationBenchmark(JobSystemAllocationBenchmarkResults& out_results, int amountOfThreads, int amountOfJobs);
+void RunJobSystemPriorityBenchmark(JobSystemPriorityBenchmarkResults& out_results, int amountOfThreads);
+void RunFileIOBenchmark(FileIOBenchmarkResults& out_results, int amountOfThreads, int amountOfFiles, int fileSizeKilobytes);
+void GetCpuTopologyReport(std::vector<std::string>& out_reportLines);
+void GetJobSystemBenchmarkReport(JobSystemBenchmarkResults const& results, std::vector<std::string>& out_reportLines);
+void GetJobSystemIdleBenchmarkReport(JobSystemIdleBenchmarkResults const& results, std::vector<std::string>& out_reportLines);
+void GetJobSystemAllocationBenchmarkReport(JobSystemAllocationBenchmarkResults const& results, std::vector<std::string>& out_reportLines);
+void GetJobSystemPriorityBenchmarkReport(JobSystemPriorityBenchmarkResults const& results, std::vector<std::string>& out_reportLines);
+void GetFileIOBenchmarkReport(FileIOBenchmarkResults const& results, std::vector<std::string>& out_reportLines);
+
+bool Command_JobSystemBenchmark(EventArgs& args);
@@ -0,0 +1,372 @@
+#include "Engine/Core/JobSystemStressTest.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <memory>
+
+constexpr int CLAIM_LATENCY_SAMPLES = 2000;
+constexpr int FAN_OUT_JOBS_PER_LEVEL = 64;
+constexpr int MIXED_JOB_TYPES[] = { 1, 2, 4, 1 | 2, 2 | 4, DEFAULT_JOB_ID };
+constexpr int AMOUNT_OF_MIXED_JOB_TYPES = sizeof(MIXED_JOB_TYPES) / sizeof(MIXED_JOB_TYPES[0]);
+constexpr double CLEAR_WAIT_TIMEOUT_SECONDS = 1.0; // Nothing is left to run after the clear, so anything slower means the wait would hang
+
+// One execution count per job, checked once the scenario is done
+class JobExecutionCounts {
+public:
+	JobExecutionCounts(int amountOfJobs) :
+		m_counts(new std::atomic<int>[amountOfJobs]),
+		m_amountOfJobs(amountOfJobs)
+	{
+		for (int jobIndex = 0; jobIndex < amountOfJobs; jobIndex++) {
+			m_counts[jobIndex] = 0;
+		}
+	}
+
+	void CountExecution(int jobIndex) { m_counts[jobIndex].fetch_add(1, std::memory_order_relaxed); }
+	int GetAmountOfErrors() const {
+		int amountOfErrors = 0;
+		for (int jobIndex = 0; jobIndex < m_amountOfJobs; jobIndex++) {
+			if (m_counts[jobIndex].load() != 1) amountOfErrors++;
+		}
+		return amountOfErrors;
+	}
+
+private:
+	std::unique_ptr<std::atomic<int>[]> m_counts;
+	int m_amountOfJobs = 0;
+};
+
+double JobSystemStressResult::GetNanosecondsPerJob() const
+{
+	if (m_amountOfJobs <= 0) return 0.0;
+	return (m_elapsedSeconds * 1'000'000'000.0) / static_cast<double>(m_amountOfJobs);
+}
+
+static JobSystemStressResult MakeStressResult(char const* scenarioName, int amountOfThreads, int amountOfJobs)
+{
+	JobSystemStressResult result;
+	result.m_scenarioName = scenarioName;
+	result.m_amountOfThreads = amountOfThreads;
+	result.m_amountOfJobs = amountOfJobs;
+	return result;
+}
+
+// Only the QueueLambdaJob calls, with the workers already draining the queues behind the submitting thread
+static JobSystemStressResult MeasureSubmitCost(int amountOfThreads, int amountOfJobs)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	JobSystemStressResult result = MakeStressResult("Submit", amountOfThreads, amountOfJobs);
+	JobExecutionCounts executionCounts(amountOfJobs);
+	JobCounter jobsCounter;
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < amountOfJobs; jobIndex++) {
+		jobSystem.QueueLambdaJob([&executionCounts, jobIndex]() { executionCounts.CountExecution(jobIndex); }, &jobsCounter);
+	}
+	result.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	jobSystem.WaitUntilCounterCompletion(jobsCounter);
+	result.m_amountOfErrors = executionCounts.GetAmountOfErrors();
+	jobSystem.Shutdown();
+	return result;
+}
+
+// From submitting to the last job done, the waiting thread helps like it would during a frame
+static JobSystemStressResult MeasureEmptyJobThroughput(int amountOfThreads, int amountOfJobs)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	JobSystemStressResult result = MakeStressResult("EmptyJobs", amountOfThreads, amountOfJobs);
+	JobExecutionCounts executionCounts(amountOfJobs);
+	JobCounter jobsCounter;
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < amountOfJobs; jobIndex++) {
+		jobSystem.QueueLambdaJob([&executionCounts, jobIndex]() { executionCounts.CountExecution(jobIndex); }, &jobsCounter);
+	}
+	jobSystem.WaitUntilCounterCompletion(jobsCounter);
+	result.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	result.m_amountOfErrors = executionCounts.GetAmountOfErrors();
+	jobSystem.Shutdown();
+	return result;
+}
+
+// One job at a time, from QueueLambdaJob until a worker starts it. The submitting thread doesn't help, it only yields,
+// and the next job is queued right away so the workers are still spinning (RunJobSystemIdleBenchmark measures parked ones)
+static JobSystemStressResult MeasureClaimLatency(int amountOfThreads)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	JobSystemStressResult result = MakeStressResult("ClaimLatency", amountOfThreads, CLAIM_LATENCY_SAMPLES);
+	JobExecutionCounts executionCounts(CLAIM_LATENCY_SAMPLES);
+	std::vector<double> latencies;
+	latencies.reserve(CLAIM_LATENCY_SAMPLES);
+
+	for (int sampleIndex = 0; sampleIndex < CLAIM_LATENCY_SAMPLES; sampleIndex++) {
+		std::atomic<double> executionStartTime = 0.0;
+		double queueTime = GetCurrentTimeSeconds();
+		jobSystem.QueueLambdaJob([&executionCounts, &executionStartTime, sampleIndex]() {
+			executionCounts.CountExecution(sampleIndex);
+			executionStartTime = GetCurrentTimeSeconds();
+		});
+		while (executionStartTime.load() == 0.0) {
+			std::this_thread::yield();
+		}
+
+		double latency = executionStartTime.load() - queueTime;
+		latencies.push_back(latency);
+		result.m_elapsedSeconds += latency;
+	}
+
+	jobSystem.WaitUntilQueuedJobsCompletion();
+	std::sort(latencies.begin(), latencies.end());
+	result.m_medianLatencyNanoseconds = latencies[latencies.size() / 2] * 1'000'000'000.0;
+	result.m_p99LatencyNanoseconds = latencies[(latencies.size() * 99) / 100] * 1'000'000'000.0;
+	result.m_amountOfErrors = executionCounts.GetAmountOfErrors();
+	jobSystem.Shutdown();
+	return result;
+}
+
+// Levels of jobs where every job of a level depends on the whole previous level, so each level fans out and back in through a counter
+static JobSystemStressResult MeasureFanOutFanIn(int amountOfThreads, int amountOfJobs)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	int amountOfLevels = amountOfJobs / FAN_OUT_JOBS_PER_LEVEL;
+	if (amountOfLevels < 1) amountOfLevels = 1;
+	JobSystemStressResult result = MakeStressResult("FanOutFanIn", amountOfThreads, amountOfLevels * FAN_OUT_JOBS_PER_LEVEL);
+	JobExecutionCounts executionCounts(result.m_amountOfJobs);
+	std::unique_ptr<JobCounter[]> levelCounters(new JobCounter[amountOfLevels]);
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int levelIndex = 0; levelIndex < amountOfLevels; levelIndex++) {
+		for (int jobInLevel = 0; jobInLevel < FAN_OUT_JOBS_PER_LEVEL; jobInLevel++) {
+			int jobIndex = levelIndex * FAN_OUT_JOBS_PER_LEVEL + jobInLevel;
+			auto countExecution = [&executionCounts, jobIndex]() { executionCounts.CountExecution(jobIndex); };
+			if (levelIndex == 0) {
+				jobSystem.QueueLambdaJob(countExecution, &levelCounters[levelIndex]);
+			}
+			else {
+				jobSystem.QueueLambdaJobAfter(countExecution, levelCounters[levelIndex - 1], &levelCounters[levelIndex]);
+			}
+		}
+	}
+	jobSystem.WaitUntilCounterCompletion(levelCounters[amountOfLevels - 1]);
+	result.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	result.m_amountOfErrors = executionCounts.GetAmountOfErrors();
+	jobSystem.Shutdown();
+	return result;
+}
+
+// Several threads outside of the JobSystem submitting at once, they all go through the shared injection queue
+static JobSystemStressResult MeasureManyProducers(int amountOfThreads, int amountOfJobs, int amountOfProducers)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	JobSystemStressResult result = MakeStressResult("ManyProducers", amountOfThreads, amountOfJobs);
+	JobExecutionCounts executionCounts(amountOfJobs);
+	JobCounter jobsCounter;
+	std::atomic<bool> isSubmitting = false;
+
+	std::vector<std::thread*> producerThreads;
+	for (int producerIndex = 0; producerIndex < amountOfProducers; producerIndex++) {
+		int firstJobIndex = (amountOfJobs * producerIndex) / amountOfProducers;
+		int lastJobIndex = (amountOfJobs * (producerIndex + 1)) / amountOfProducers;
+		producerThreads.push_back(new std::thread([&, firstJobIndex, lastJobIndex]() {
+			while (!isSubmitting.load()) {
+				std::this_thread::yield();
+			}
+			for (int jobIndex = firstJobIndex; jobIndex < lastJobIndex; jobIndex++) {
+				jobSystem.QueueLambdaJob([&executionCounts, jobIndex]() { executionCounts.CountExecution(jobIndex); }, &jobsCounter);
+			}
+		}));
+	}
+
+	// The counter only covers what's queued so far, so every producer has to be done before waiting on it
+	double startTime = GetCurrentTimeSeconds();
+	isSubmitting = true;
+	for (int producerIndex = 0; producerIndex < producerThreads.size(); producerIndex++) {
+		producerThreads[producerIndex]->join();
+		delete producerThreads[producerIndex];
+	}
+	jobSystem.WaitUntilCounterCompletion(jobsCounter);
+	result.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	result.m_amountOfErrors = executionCounts.GetAmountOfErrors();
+	jobSystem.Shutdown();
+	return result;
+}
+
+// Workers subscribed to 2 of 3 type bits each, with single bit, multi bit and multipurpose jobs mixed together
+static JobSystemStressResult MeasureMixedJobTypes(int amountOfThreads, int amountOfJobs)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	// Fewer than 3 workers can't cover every bit with 2 bits each, they stay multipurpose
+	if (amountOfThreads >= 3) {
+		for (int threadId = 0; threadId < amountOfThreads; threadId++) {
+			jobSystem.SetThreadJobType(threadId, (1 << (threadId % 3)) | (1 << ((threadId + 1) % 3)));
+		}
+	}
+
+	JobSystemStressResult result = MakeStressResult("MixedTypes", amountOfThreads, amountOfJobs);
+	JobExecutionCounts executionCounts(amountOfJobs);
+	JobCounter jobsCounter;
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < amountOfJobs; jobIndex++) {
+		int jobType = MIXED_JOB_TYPES[jobIndex % AMOUNT_OF_MIXED_JOB_TYPES];
+		jobSystem.QueueLambdaJob([&executionCounts, jobIndex]() { executionCounts.CountExecution(jobIndex); }, &jobsCounter, jobType);
+	}
+	jobSystem.WaitUntilCounterCompletion(jobsCounter);
+	result.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	result.m_amountOfErrors = executionCounts.GetAmountOfErrors();
+	jobSystem.Shutdown();
+	return result;
+}
+
+// Jobs and their continuations cleared while every worker is stuck on a gate job. None of them may run, and waiting on their
+// counters and on the whole system has to return instead of hanging on jobs that are gone
+static JobSystemStressResult MeasureClearThenWait(int amountOfThreads, int amountOfJobs)
+{
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = amountOfThreads;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.Startup();
+
+	JobSystemStressResult result = MakeStressResult("ClearThenWait", amountOfThreads, amountOfJobs);
+	std::atomic<bool> isGateOpen = false;
+	std::atomic<int> amountOfGatedWorkers = 0;
+	std::atomic<int> amountOfExecutedJobs = 0;
+	JobCounter rootCounter;
+	JobCounter continuationCounter;
+
+	for (int threadId = 0; threadId < amountOfThreads; threadId++) {
+		jobSystem.QueueLambdaJob([&isGateOpen, &amountOfGatedWorkers]() {
+			amountOfGatedWorkers++;
+			while (!isGateOpen.load()) {
+				std::this_thread::yield();
+			}
+		});
+	}
+	while (amountOfGatedWorkers.load() < amountOfThreads) {
+		std::this_thread::yield();
+	}
+
+	int amountOfRootJobs = (amountOfJobs + 1) / 2;
+	for (int jobIndex = 0; jobIndex < amountOfJobs; jobIndex++) {
+		auto countExecution = [&amountOfExecutedJobs]() { amountOfExecutedJobs++; };
+		if (jobIndex < amountOfRootJobs) {
+			jobSystem.QueueLambdaJob(countExecution, &rootCounter);
+		}
+		else {
+			jobSystem.QueueLambdaJobAfter(countExecution, rootCounter, &continuationCounter);
+		}
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	jobSystem.ClearQueuedJobs();
+	bool areCountersComplete = jobSystem.WaitUntilCounterCompletion(rootCounter, CLEAR_WAIT_TIMEOUT_SECONDS) &&
+		jobSystem.WaitUntilCounterCompletion(continuationCounter, CLEAR_WAIT_TIMEOUT_SECONDS);
+	result.m_elapsedSeconds = GetCurrentTimeSeconds() - startTime;
+
+	isGateOpen = true;
+	bool isJobSystemIdle = jobSystem.WaitUntilQueuedJobsCompletion(CLEAR_WAIT_TIMEOUT_SECONDS);
+
+	result.m_amountOfErrors = amountOfExecutedJobs.load() + ((areCountersComplete) ? 0 : 1) + ((isJobSystemIdle) ? 0 : 1);
+	jobSystem.Shutdown();
+	return result;
+}
+
+void RunJobSystemStressTest(JobSystemStressResults& out_results, int maxThreads, int amountOfJobs, int amountOfProducers)
+{
+	if (maxThreads <= 0) {
+		maxThreads = (int)std::thread::hardware_concurrency();
+	}
+	if (maxThreads <= 0) {
+		maxThreads = 1;
+	}
+	if (amountOfProducers <= 0) {
+		amountOfProducers = maxThreads;
+	}
+
+	std::vector<int> threadCounts;
+	for (int amountOfThreads = 1; amountOfThreads < maxThreads; amountOfThreads *= 2) {
+		threadCounts.push_back(amountOfThreads);
+	}
+	threadCounts.push_back(maxThreads);
+
+	// Grouped by scenario so each one reads as a curve
+	for (int countIndex = 0; countIndex < threadCounts.size(); countIndex++) {
+		out_results.push_back(MeasureSubmitCost(threadCounts[countIndex], amountOfJobs));
+	}
+	for (int countIndex = 0; countIndex < threadCounts.size(); countIndex++) {
+		out_results.push_back(MeasureClaimLatency(threadCounts[countIndex]));
+	}
+	for (int countIndex = 0; countIndex < threadCounts.size(); countIndex++) {
+		out_results.push_back(MeasureEmptyJobThroughput(threadCounts[countIndex], amountOfJobs));
+	}
+	for (int countIndex = 0; countIndex < threadCounts.size(); countIndex++) {
+		out_results.push_back(MeasureFanOutFanIn(threadCounts[countIndex], amountOfJobs));
+	}
+	for (int countIndex = 0; countIndex < threadCounts.size(); countIndex++) {
+		out_results.push_back(MeasureManyProducers(threadCounts[countIndex], amountOfJobs, amountOfProducers));
+	}
+	for (int countIndex = 0; countIndex < threadCounts.size(); countIndex++) {
+		out_results.push_back(MeasureMixedJobTypes(threadCounts[countIndex], amountOfJobs));
+	}
+	for (int countIndex = 0; countIndex < threadCounts.size(); countIndex++) {
+		out_results.push_back(MeasureClearThenWait(threadCounts[countIndex], amountOfJobs));
+	}
+}
+
+void GetJobSystemStressTestReport(JobSystemStressResults const& results, std::vector<std::string>& out_reportLines)
+{
+	for (int resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+		JobSystemStressResult const& result = results[resultIndex];
+
+		double singleThreadNanoseconds = 0.0;
+		for (int otherIndex = 0; otherIndex < results.size(); otherIndex++) {
+			JobSystemStressResult const& otherResult = results[otherIndex];
+			if ((otherResult.m_amountOfThreads == 1) && (otherResult.m_scenarioName == result.m_scenarioName)) {
+				singleThreadNanoseconds = otherResult.GetNanosecondsPerJob();
+				break;
+			}
+		}
+
+		double nanosecondsPerJob = result.GetNanosecondsPerJob();
+		double speedUp = (nanosecondsPerJob > 0.0) ? singleThreadNanoseconds / nanosecondsPerJob : 0.0;
+		std::string reportLine = Stringf("%-16s threads: %3d jobs: %8d %10.1f ns/job vs 1 thread: %5.2fx",
+			result.m_scenarioName.c_str(), result.m_amountOfThreads, result.m_amountOfJobs, nanosecondsPerJob, speedUp);
+		if (result.m_p99LatencyNanoseconds > 0.0) {
+			reportLine += Stringf(" median: %8.0f ns p99: %8.0f ns", result.m_medianLatencyNanoseconds, result.m_p99LatencyNanoseconds);
+		}
+		if (result.m_amountOfErrors > 0) {
+			reportLine += Stringf(" ERRORS: %d", result.m_amountOfErrors);
+		}
+		out_reportLines.push_back(reportLine);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+#include <vector>
+
+// The JobSystem's own overhead, measured with empty jobs for 1, 2, 4... workers so a change to JobSystem.cpp shows up as a scaling curve.
+// Every job also counts its executions, so any job that ran twice (or never) shows up as an error
+struct JobSystemStressResult {
+	std::string m_scenarioName;
+	int m_amountOfThreads = 0;
+	int m_amountOfJobs = 0;
+	double m_elapsedSeconds = 0.0;
+	double m_medianLatencyNanoseconds = 0.0; // Latency scenarios only
+	double m_p99LatencyNanoseconds = 0.0;
+	int m_amountOfErrors = 0; // Jobs that didn't run exactly once (ClearThenWait: cleared jobs that ran, and waits that didn't return)
+
+	double GetNanosecondsPerJob() const;
+};
+
+typedef std::vector<JobSystemStressResult> JobSystemStressResults;
+
+void RunJobSystemStressTest(JobSystemStressResults& out_results, int maxThreads, int amountOfJobs, int amountOfProducers);
+void GetJobSystemStressTestReport(JobSystemStressResults const& results, std::vector<std::string>& out_reportLines);
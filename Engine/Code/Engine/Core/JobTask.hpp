@@ -0,0 +1,196 @@
+#pragma once
+#include "Engine/Core/JobSystem.hpp"
+
+// Coroutines need /std:c++20 (or newer), projects still on C++17 just don't get Task<T>
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+
+#define JOB_TASKS_ENABLED
+
+// Lazy coroutine run by JobSystem workers. Nothing runs until it's started (Start from regular code, co_await from another task).
+// co_await on a Task runs it right away on the same worker and comes back once it finishes. co_await on a JobCounter (or an
+// I/O request's counter) suspends without holding the worker, and a job resumes the task once the counter reaches 0
+//
+//	Task<Image*> LoadImageAsync(std::string path) {
+//		co_await ScheduleOnJobSystem(JobPriority::BACKGROUND);
+//		std::vector<unsigned char> fileData = co_await ReadFileAsync(path);
+//		co_return DecodeImage(fileData);
+//	}
+template<typename T_Result>
+class Task;
+
+class TaskPromiseBase {
+	template<typename T_Result>
+	friend class Task;
+
+public:
+	struct FinalAwaiter {
+		bool await_ready() const noexcept { return false; }
+		template<typename T_Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<T_Promise> finishedCoroutine) noexcept {
+			TaskPromiseBase& promise = finishedCoroutine.promise();
+			std::coroutine_handle<> continuation = promise.m_continuation;
+			JobSystem* jobSystem = promise.m_jobSystem;
+
+			// Whoever waits on a started task may destroy it as soon as this is set, nothing can touch the frame afterwards.
+			// Sequentially consistent so either Wait sees it, or the notification sees Wait's thread counted as waiting
+			promise.m_isDone.store(true);
+			if (jobSystem) jobSystem->NotifyWaitingThreads();
+			if (continuation) return continuation;
+			return std::noop_coroutine();
+		}
+		void await_resume() const noexcept {}
+	};
+
+	std::suspend_always initial_suspend() const noexcept { return {}; }
+	FinalAwaiter final_suspend() const noexcept { return {}; }
+	void unhandled_exception() const noexcept { std::terminate(); }
+
+	JobSystem* GetJobSystem() const { return m_jobSystem; }
+
+protected:
+	JobSystem* m_jobSystem = nullptr; // Children inherit it from whoever co_awaits them
+	std::coroutine_handle<> m_continuation = nullptr;
+	std::atomic<bool> m_isDone = false;
+};
+
+template<typename T_Result>
+class TaskPromise : public TaskPromiseBase {
+public:
+	Task<T_Result> get_return_object();
+	template<typename T_Value>
+	void return_value(T_Value&& value) { m_result.emplace(std::forward<T_Value>(value)); }
+
+	T_Result& GetResult() { return *m_result; }
+
+private:
+	std::optional<T_Result> m_result;
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+	Task<void> get_return_object();
+	void return_void() const {}
+
+	void GetResult() const {}
+};
+
+template<typename T_Result = void>
+class Task {
+public:
+	typedef TaskPromise<T_Result> promise_type;
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	Task() = default;
+	explicit Task(Handle coroutine) : m_coroutine(coroutine) {}
+	Task(Task const& copy) = delete;
+	Task(Task&& moved) noexcept : m_coroutine(moved.m_coroutine) { moved.m_coroutine = nullptr; }
+	~Task() { if (m_coroutine) m_coroutine.destroy(); }
+
+	Task& operator=(Task&& moved) noexcept {
+		if (this != &moved) {
+			if (m_coroutine) m_coroutine.destroy();
+			m_coroutine = moved.m_coroutine;
+			moved.m_coroutine = nullptr;
+		}
+		return *this;
+	}
+
+	// Starts a top level task on one of the workers
+	void Start(JobSystem& jobSystem, JobPriority priority = JobPriority::NORMAL) {
+		Handle coroutine = m_coroutine;
+		coroutine.promise().m_jobSystem = &jobSystem;
+		jobSystem.QueueLambdaJob([coroutine]() { coroutine.resume(); }, nullptr, DEFAULT_JOB_ID, priority);
+	}
+
+	bool IsValid() const { return m_coroutine != nullptr; }
+	bool IsDone() const { return m_coroutine && m_coroutine.promise().m_isDone.load(std::memory_order_acquire); }
+
+	// Blocks a regular (non coroutine) thread until a started task is done. Runs other jobs in the meantime (see
+	// JobSystemConfig::m_executeJobsWhileWaiting) and sleeps like the other JobSystem waits when there are none
+	void Wait() const {
+		m_coroutine.promise().m_jobSystem->WaitUntilFlagIsSet(m_coroutine.promise().m_isDone);
+	}
+
+	decltype(auto) GetResult() { return m_coroutine.promise().GetResult(); }
+
+	struct Awaiter {
+		Handle m_coroutine;
+
+		bool await_ready() const noexcept { return !m_coroutine || m_coroutine.done(); }
+		template<typename T_AwaitingPromise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<T_AwaitingPromise> awaitingCoroutine) noexcept {
+			m_coroutine.promise().m_jobSystem = awaitingCoroutine.promise().GetJobSystem();
+			m_coroutine.promise().m_continuation = awaitingCoroutine;
+			return m_coroutine; // Runs the child on this same thread, no job needed
+		}
+		T_Result await_resume() {
+			if constexpr (!std::is_void_v<T_Result>) {
+				return std::move(m_coroutine.promise().GetResult());
+			}
+		}
+	};
+
+	Awaiter operator co_await() && { return Awaiter{ m_coroutine }; }
+	Awaiter operator co_await() & { return Awaiter{ m_coroutine }; }
+
+private:
+	Handle m_coroutine = nullptr;
+};
+
+template<typename T_Result>
+Task<T_Result> TaskPromise<T_Result>::get_return_object()
+{
+	return Task<T_Result>(std::coroutine_handle<TaskPromise<T_Result>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object()
+{
+	return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// co_await counter: suspends until every job signaling the counter is done, then resumes as a continuation job
+struct JobCounterAwaiter {
+	JobCounter& m_counter;
+	JobPriority m_priority = JobPriority::NORMAL;
+
+	bool await_ready() const noexcept { return m_counter.IsComplete(); }
+	template<typename T_Promise>
+	void await_suspend(std::coroutine_handle<T_Promise> awaitingCoroutine) {
+		std::coroutine_handle<> coroutine = awaitingCoroutine;
+		JobSystem* jobSystem = awaitingCoroutine.promise().GetJobSystem();
+		jobSystem->QueueLambdaJobAfter([coroutine]() { coroutine.resume(); }, m_counter, nullptr, DEFAULT_JOB_ID, m_priority);
+	}
+	void await_resume() const noexcept {}
+};
+
+inline JobCounterAwaiter operator co_await(JobCounter& counter)
+{
+	return JobCounterAwaiter{ counter };
+}
+
+inline JobCounterAwaiter WaitForCounter(JobCounter& counter, JobPriority resumePriority)
+{
+	return JobCounterAwaiter{ counter, resumePriority };
+}
+
+// co_await ScheduleOnJobSystem(): moves the rest of the task into a new job, e.g. to change priority or leave the main thread
+struct ScheduleOnJobSystem {
+	JobPriority m_priority = JobPriority::NORMAL;
+
+	ScheduleOnJobSystem(JobPriority priority = JobPriority::NORMAL) : m_priority(priority) {}
+
+	bool await_ready() const noexcept { return false; }
+	template<typename T_Promise>
+	void await_suspend(std::coroutine_handle<T_Promise> awaitingCoroutine) {
+		std::coroutine_handle<> coroutine = awaitingCoroutine;
+		awaitingCoroutine.promise().GetJobSystem()->QueueLambdaJob([coroutine]() { coroutine.resume(); }, nullptr, DEFAULT_JOB_ID, m_priority);
+	}
+	void await_resume() const noexcept {}
+};
+
+#endif
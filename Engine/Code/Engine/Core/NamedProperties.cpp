@@ -1,33 +1,220 @@
 #include "Engine/Core/NamedProperties.hpp"
+#include <atomic>
 
-NamedProperties::NamedProperties(NamedProperties const& otherNamedProperties)
+struct NamedPropertyTable {
+	std::atomic<int> m_referenceCount = 1;
+	NamedPropertySlot* m_slots = nullptr; // Linear probing, never more than 3/4 full
+	int m_capacity = 0; // Power of two
+	int m_amountOfValues = 0;
+
+	NamedPropertyTable(int capacity) :
+		m_slots(new NamedPropertySlot[capacity]),
+		m_capacity(capacity) {}
+	NamedPropertyTable(NamedPropertyTable const& otherTable);
+	~NamedPropertyTable();
+
+	void DestroyValues();
+	void Grow();
+};
+
+// Only called once the hashes match, so this is nearly always comparing the same name
+static bool AreNamesEqual(std::string const& nameA, std::string const& nameB)
 {
-	std::map<std::string, NamedPropertyBase*> const& otherProperties = otherNamedProperties.m_keyValuePairs;
+	if (nameA.size() != nameB.size()) return false;
+	for (int charIndex = 0; charIndex < nameA.size(); charIndex++) {
+		unsigned char characterA = static_cast<unsigned char>(nameA[charIndex]);
+		unsigned char characterB = static_cast<unsigned char>(nameB[charIndex]);
+		if (characterA == characterB) continue;
+		if ((characterA >= 'A') && (characterA <= 'Z')) characterA += 'a' - 'A';
+		if ((characterB >= 'A') && (characterB <= 'Z')) characterB += 'a' - 'A';
+		if (characterA != characterB) return false;
+	}
+	return true;
+}
 
-	std::map<std::string, NamedPropertyBase*>::const_iterator it;
-	for (it = otherProperties.begin(); (it != otherProperties.end());) {
-		m_keyValuePairs[it->first] = it->second->GetClone();
+NamedPropertyTable::NamedPropertyTable(NamedPropertyTable const& otherTable) :
+	m_slots(new NamedPropertySlot[otherTable.m_capacity]),
+	m_capacity(otherTable.m_capacity),
+	m_amountOfValues(otherTable.m_amountOfValues)
+{
+	// Same capacity means same slots, nothing gets hashed or probed again
+	for (int slotIndex = 0; slotIndex < m_capacity; slotIndex++) {
+		NamedPropertySlot const& otherSlot = otherTable.m_slots[slotIndex];
+		if (!otherSlot.m_type) continue;
 
+		NamedPropertySlot& slot = m_slots[slotIndex];
+		slot.m_keyHash = otherSlot.m_keyHash;
+		slot.m_name = otherSlot.m_name;
+		otherSlot.m_type->m_copyValue(slot.m_valueStorage, otherSlot.m_valueStorage);
+		slot.m_type = otherSlot.m_type;
 	}
 }
 
+NamedPropertyTable::~NamedPropertyTable()
+{
+	DestroyValues();
+	delete[] m_slots;
+	m_slots = nullptr;
+}
+
+void NamedPropertyTable::DestroyValues()
+{
+	for (int slotIndex = 0; slotIndex < m_capacity; slotIndex++) {
+		NamedPropertySlot& slot = m_slots[slotIndex];
+		if (!slot.m_type) continue;
+
+		slot.m_type->m_destroyValue(slot.m_valueStorage);
+		slot.m_type = nullptr;
+		slot.m_name.clear();
+	}
+	m_amountOfValues = 0;
+}
+
+void NamedPropertyTable::Grow()
+{
+	int newCapacity = m_capacity * 2;
+	NamedPropertySlot* newSlots = new NamedPropertySlot[newCapacity];
+
+	size_t slotMask = (size_t)newCapacity - 1;
+	for (int oldSlotIndex = 0; oldSlotIndex < m_capacity; oldSlotIndex++) {
+		NamedPropertySlot& oldSlot = m_slots[oldSlotIndex];
+		if (!oldSlot.m_type) continue;
+
+		size_t slotIndex = oldSlot.m_keyHash & slotMask;
+		while (newSlots[slotIndex].m_type) {
+			slotIndex = (slotIndex + 1) & slotMask;
+		}
+
+		NamedPropertySlot& newSlot = newSlots[slotIndex];
+		newSlot.m_keyHash = oldSlot.m_keyHash;
+		newSlot.m_name = std::move(oldSlot.m_name);
+		oldSlot.m_type->m_relocateValue(newSlot.m_valueStorage, oldSlot.m_valueStorage);
+		newSlot.m_type = oldSlot.m_type;
+		oldSlot.m_type = nullptr;
+	}
+
+	delete[] m_slots;
+	m_slots = newSlots;
+	m_capacity = newCapacity;
+}
+
+NamedProperties::NamedProperties(NamedProperties const& otherNamedProperties) :
+	m_table(otherNamedProperties.m_table)
+{
+	if (m_table) {
+		m_table->m_referenceCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+NamedProperties::NamedProperties(NamedProperties&& otherNamedProperties) noexcept :
+	m_table(otherNamedProperties.m_table)
+{
+	otherNamedProperties.m_table = nullptr;
+}
+
 NamedProperties::~NamedProperties()
 {
-	for (auto& [key, value] : m_keyValuePairs) {
-		if (value) {
-			delete value;
-			value = nullptr;
+	ReleaseTable();
+}
+
+int NamedProperties::GetAmountOfValues() const
+{
+	return (m_table) ? m_table->m_amountOfValues : 0;
+}
+
+bool NamedProperties::IsSharingValues() const
+{
+	return m_table && (m_table->m_referenceCount.load(std::memory_order_acquire) > 1);
+}
+
+void NamedProperties::Clear()
+{
+	if (IsSharingValues()) {
+		ReleaseTable();
+	}
+	else if (m_table) {
+		m_table->DestroyValues();
+	}
+}
+
+NamedProperties& NamedProperties::operator=(NamedProperties const& otherNamedProperties)
+{
+	if (m_table == otherNamedProperties.m_table) return *this;
+
+	if (otherNamedProperties.m_table) {
+		otherNamedProperties.m_table->m_referenceCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	ReleaseTable();
+	m_table = otherNamedProperties.m_table;
+	return *this;
+}
+
+NamedProperties& NamedProperties::operator=(NamedProperties&& otherNamedProperties) noexcept
+{
+	if (this == &otherNamedProperties) return *this;
+
+	ReleaseTable();
+	m_table = otherNamedProperties.m_table;
+	otherNamedProperties.m_table = nullptr;
+	return *this;
+}
+
+NamedPropertySlot const* NamedProperties::FindSlot(std::string const& name, size_t keyHash) const
+{
+	if (!m_table || (m_table->m_amountOfValues == 0)) return nullptr;
+
+	// Never full, so there's always an empty slot ending the probe
+	NamedPropertySlot const* slots = m_table->m_slots;
+	size_t slotMask = (size_t)m_table->m_capacity - 1;
+	for (size_t slotIndex = keyHash & slotMask;; slotIndex = (slotIndex + 1) & slotMask) {
+		NamedPropertySlot const& slot = slots[slotIndex];
+		if (!slot.m_type) return nullptr;
+		if ((slot.m_keyHash == keyHash) && AreNamesEqual(slot.m_name, name)) return &slot;
+	}
+}
+
+NamedPropertySlot& NamedProperties::FindOrAddSlot(std::string const& name, size_t keyHash)
+{
+	MakeTableWritable();
+	if ((m_table->m_amountOfValues + 1) * 4 > m_table->m_capacity * 3) {
+		m_table->Grow();
+	}
+
+	NamedPropertySlot* slots = m_table->m_slots;
+	size_t slotMask = (size_t)m_table->m_capacity - 1;
+	for (size_t slotIndex = keyHash & slotMask;; slotIndex = (slotIndex + 1) & slotMask) {
+		NamedPropertySlot& slot = slots[slotIndex];
+		if (!slot.m_type) {
+			slot.m_keyHash = keyHash;
+			slot.m_name = name;
+			m_table->m_amountOfValues++;
+			return slot;
 		}
+		if ((slot.m_keyHash == keyHash) && AreNamesEqual(slot.m_name, name)) return slot;
 	}
 }
 
-void NamedProperties::operator=(NamedProperties const& otherNamedProperties)
+void NamedProperties::MakeTableWritable()
 {
-	std::map<std::string, NamedPropertyBase*> const& otherProperties = otherNamedProperties.m_keyValuePairs;
+	if (!m_table) {
+		m_table = new NamedPropertyTable(NAMED_PROPERTIES_INITIAL_CAPACITY);
+		return;
+	}
 
-	std::map<std::string, NamedPropertyBase*>::const_iterator it;
-	for (it = otherProperties.begin(); (it != otherProperties.end()); it++) {
-		m_keyValuePairs[it->first] = it->second->GetClone();
+	// Acquire pairs with the release in ReleaseTable: a copy that was just destroyed on another thread is done reading
+	if (m_table->m_referenceCount.load(std::memory_order_acquire) == 1) return;
+
+	NamedPropertyTable* clonedTable = new NamedPropertyTable(*m_table);
+	ReleaseTable();
+	m_table = clonedTable;
+}
+
+void NamedProperties::ReleaseTable()
+{
+	if (!m_table) return;
 
+	if (m_table->m_referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		delete m_table;
 	}
+	m_table = nullptr;
 }
@@ -1,113 +1,176 @@
 #pragma once
-#include <map>
+#include <new>
 #include <string>
-#include <typeinfo>
+#include <type_traits>
+#include <utility>
 #include "Engine/Core/StringUtils.hpp"
 
-class NamedPropertyBase {
-public:
-	virtual ~NamedPropertyBase() = default;
-
-	virtual NamedPropertyBase* GetClone() const = 0;
+constexpr int NAMED_PROPERTY_INLINE_BYTES = 32; // Values up to this size live in the slot itself, bigger ones get their own allocation
+constexpr int NAMED_PROPERTIES_INITIAL_CAPACITY = 4; // Most EventArgs carry up to 3 values
 
-	virtual bool IsType(std::type_info const& type) const = 0;
+// How to copy and destroy one type of value. There's a single one per type, so its address doubles as the type tag
+struct NamedPropertyType {
+	void (*m_copyValue)(void* destination, void const* source) = nullptr; // Into uninitialized storage
+	void (*m_relocateValue)(void* destination, void* source) = nullptr; // Leaves the source uninitialized
+	void (*m_destroyValue)(void* storage) = nullptr;
 };
 
 template<typename T_Value>
-class NamedProperty : public NamedPropertyBase {
-public:
-	T_Value m_data;
+struct NamedPropertyTypeOf {
+	static constexpr bool IS_STORED_INLINE = (sizeof(T_Value) <= NAMED_PROPERTY_INLINE_BYTES) && (alignof(T_Value) <= alignof(void*)) && std::is_nothrow_move_constructible_v<T_Value>;
 
-	NamedPropertyBase* GetClone() const {
-		NamedProperty<T_Value>* clone = new NamedProperty<T_Value>();
-		clone->m_data = m_data;
-		return clone;
+	static T_Value* GetValue(void* storage) {
+		if constexpr (IS_STORED_INLINE) return std::launder(reinterpret_cast<T_Value*>(storage));
+		else return *reinterpret_cast<T_Value**>(storage);
+	}
+	static T_Value const* GetValue(void const* storage) {
+		if constexpr (IS_STORED_INLINE) return std::launder(reinterpret_cast<T_Value const*>(storage));
+		else return *reinterpret_cast<T_Value* const*>(storage);
 	}
 
-	virtual bool IsType(std::type_info const& type) const override { return (typeid(m_data).hash_code() == type.hash_code()); }
+	static void ConstructValue(void* storage, T_Value const& value) {
+		if constexpr (IS_STORED_INLINE) new (storage) T_Value(value);
+		else *reinterpret_cast<T_Value**>(storage) = new T_Value(value);
+	}
+	static void CopyValue(void* destination, void const* source) { ConstructValue(destination, *GetValue(source)); }
+	static void RelocateValue(void* destination, void* source) {
+		if constexpr (IS_STORED_INLINE) {
+			new (destination) T_Value(std::move(*GetValue(source)));
+			GetValue(source)->~T_Value();
+		}
+		else {
+			*reinterpret_cast<T_Value**>(destination) = GetValue(source);
+		}
+	}
+	static void DestroyValue(void* storage) {
+		if constexpr (IS_STORED_INLINE) GetValue(storage)->~T_Value();
+		else delete GetValue(storage);
+	}
+
+	// Deliberately not const: /OPT:ICF can give identical const data (and these functions are identical for int and unsigned) one
+	// address, which would make two types share a tag. Writable data is never folded
+	static inline NamedPropertyType s_type = { &CopyValue, &RelocateValue, &DestroyValue };
 };
 
+struct NamedPropertySlot {
+	NamedPropertyType const* m_type = nullptr; // nullptr while the slot is empty
+	size_t m_keyHash = 0;
+	std::string m_name; // As first set, lookups ignore the case
+	alignas(void*) unsigned char m_valueStorage[NAMED_PROPERTY_INLINE_BYTES]; // The value itself, or a pointer to it when it doesn't fit
+};
+
+struct NamedPropertyTable;
+
+// Name hashed once, for names looked up every frame
+//	static NamedPropertyKey const s_keyCodeKey("KeyCode");
+//	unsigned char keyCode = args.GetValue(s_keyCodeKey, (unsigned char)0);
+class NamedPropertyKey {
+public:
+	explicit NamedPropertyKey(std::string const& name) :
+		m_name(name),
+		m_keyHash(GetCaseInsensitiveHash(name)) {}
+
+	std::string m_name;
+	size_t m_keyHash = 0;
+};
 
+// Values of any copyable type by case insensitive name. Slots are a flat open addressing table, allocated on the first SetValue,
+// so empty args cost nothing and small values never touch the heap.
+// Copies share the table (copy on write): copying args to forward them is a reference count increment, and the table is only cloned
+// once one of the copies gets modified. Copies can be read and destroyed on different threads, each copy still belongs to one thread
 class NamedProperties {
 public:
 	NamedProperties() = default;
 	NamedProperties(NamedProperties const& otherNamedProperties);
+	NamedProperties(NamedProperties&& otherNamedProperties) noexcept;
 	~NamedProperties();
 
-
 	template<typename T_Value>
 	inline T_Value GetValue(std::string const& name, T_Value const& defaultValue) const;
 	template<typename T_Value>
 	inline void SetValue(std::string const& name, T_Value const& value);
+	template<typename T_Value>
+	inline T_Value GetValue(NamedPropertyKey const& key, T_Value const& defaultValue) const;
+	template<typename T_Value>
+	inline void SetValue(NamedPropertyKey const& key, T_Value const& value);
 
 	inline std::string GetValue(std::string const& name, char const* defaultValue) const;
 	inline void SetValue(std::string const& name, char const* value);
+	inline std::string GetValue(NamedPropertyKey const& key, char const* defaultValue) const;
+	inline void SetValue(NamedPropertyKey const& key, char const* value);
 
-	void operator=(NamedProperties const& otherNamedProperties);
+	int GetAmountOfValues() const;
+	bool IsSharingValues() const; // With another copy, the next modification clones them
+	void Clear();
 
-	std::map<std::string, NamedPropertyBase*> m_keyValuePairs;
-};
+	NamedProperties& operator=(NamedProperties const& otherNamedProperties);
+	NamedProperties& operator=(NamedProperties&& otherNamedProperties) noexcept;
 
-template<typename T_Value>
-inline T_Value NamedProperties::GetValue(std::string const& name, T_Value const& defaultValue) const
-{
-	std::map<std::string, NamedPropertyBase*>::const_iterator it;
-	bool shouldBreak = false;
-	for (it = m_keyValuePairs.begin(); (it != m_keyValuePairs.end()) && !shouldBreak;) {
-		shouldBreak = (AreStringsEqualCaseInsensitive(name, it->first));
-		if (!shouldBreak)it++;
-	}
+private:
+	template<typename T_Value>
+	inline T_Value GetHashedValue(std::string const& name, size_t keyHash, T_Value const& defaultValue) const;
+	template<typename T_Value>
+	inline void SetHashedValue(std::string const& name, size_t keyHash, T_Value const& value);
 
-	if (it != m_keyValuePairs.end()) {
-		NamedPropertyBase const* anyTypeProperty = it->second;
+	NamedPropertySlot const* FindSlot(std::string const& name, size_t keyHash) const;
+	NamedPropertySlot& FindOrAddSlot(std::string const& name, size_t keyHash); // Added slots come back without a type, the caller constructs the value
+	void MakeTableWritable();
+	void ReleaseTable();
 
-		if (anyTypeProperty->IsType(typeid(defaultValue))) {
-			NamedProperty<T_Value> const* propertyAsCorrectType = reinterpret_cast<NamedProperty<T_Value> const*>(anyTypeProperty);
-			return propertyAsCorrectType->m_data;
-		}
-		else {
-			return defaultValue;
-		}
+private:
+	NamedPropertyTable* m_table = nullptr; // Shared with copies, nullptr until there's a value
+};
 
-	}
+template<typename T_Value>
+inline T_Value NamedProperties::GetHashedValue(std::string const& name, size_t keyHash, T_Value const& defaultValue) const
+{
+	NamedPropertySlot const* slot = FindSlot(name, keyHash);
+	if (!slot || (slot->m_type != &NamedPropertyTypeOf<T_Value>::s_type)) return defaultValue;
 
-	return defaultValue;
+	return *NamedPropertyTypeOf<T_Value>::GetValue(slot->m_valueStorage);
 }
 
 template<typename T_Value>
-inline void NamedProperties::SetValue(std::string const& name, T_Value const& value)
+inline void NamedProperties::SetHashedValue(std::string const& name, size_t keyHash, T_Value const& value)
 {
-	std::map<std::string, NamedPropertyBase*>::iterator it;
-	bool shouldBreak = false;
-	for (it = m_keyValuePairs.begin(); (it != m_keyValuePairs.end()) && !shouldBreak;) {
-		shouldBreak = (AreStringsEqualCaseInsensitive(name, it->first));
-		if (!shouldBreak)it++;
+	NamedPropertyType const* valueType = &NamedPropertyTypeOf<T_Value>::s_type;
+	NamedPropertySlot& slot = FindOrAddSlot(name, keyHash);
+	if (slot.m_type == valueType) {
+		*NamedPropertyTypeOf<T_Value>::GetValue(slot.m_valueStorage) = value;
+		return;
 	}
 
-	bool propertyNeedsToBeCreated = !(it != m_keyValuePairs.end());
-	if (it != m_keyValuePairs.end()) {
-		NamedPropertyBase* anyTypeProperty = it->second;
-
-		if (anyTypeProperty->IsType(typeid(value))) {
-			NamedProperty<T_Value>* propertyAsCorrectType = reinterpret_cast<NamedProperty<T_Value>*>(anyTypeProperty);
-			propertyAsCorrectType->m_data = value;
-			return;
-		}
-		else {
-			delete anyTypeProperty;
-			propertyNeedsToBeCreated = true;
-		}
+	// Same name with another type replaces the value
+	if (slot.m_type) {
+		slot.m_type->m_destroyValue(slot.m_valueStorage);
 	}
+	NamedPropertyTypeOf<T_Value>::ConstructValue(slot.m_valueStorage, value);
+	slot.m_type = valueType;
+}
 
-	if (propertyNeedsToBeCreated) {
-		NamedProperty<T_Value>* newProperty = new NamedProperty<T_Value>();
-		newProperty->m_data = value;
+template<typename T_Value>
+inline T_Value NamedProperties::GetValue(std::string const& name, T_Value const& defaultValue) const
+{
+	return GetHashedValue<T_Value>(name, GetCaseInsensitiveHash(name), defaultValue);
+}
 
-		m_keyValuePairs[name] = newProperty;
+template<typename T_Value>
+inline void NamedProperties::SetValue(std::string const& name, T_Value const& value)
+{
+	SetHashedValue<T_Value>(name, GetCaseInsensitiveHash(name), value);
+}
 
-	}
+template<typename T_Value>
+inline T_Value NamedProperties::GetValue(NamedPropertyKey const& key, T_Value const& defaultValue) const
+{
+	return GetHashedValue<T_Value>(key.m_name, key.m_keyHash, defaultValue);
 }
 
+template<typename T_Value>
+inline void NamedProperties::SetValue(NamedPropertyKey const& key, T_Value const& value)
+{
+	SetHashedValue<T_Value>(key.m_name, key.m_keyHash, value);
+}
 
 inline std::string NamedProperties::GetValue(std::string const& name, char const* defaultValue) const
 {
@@ -119,3 +182,12 @@ inline void NamedProperties::SetValue(std::string const& name, char const* value
 	SetValue<std::string>(name, value);
 }
 
+inline std::string NamedProperties::GetValue(NamedPropertyKey const& key, char const* defaultValue) const
+{
+	return GetValue<std::string>(key, std::string(defaultValue));
+}
+
+inline void NamedProperties::SetValue(NamedPropertyKey const& key, char const* value)
+{
+	SetValue<std::string>(key, value);
+}
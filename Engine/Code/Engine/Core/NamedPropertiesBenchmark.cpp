@@ -0,0 +1,227 @@
+#include "Engine/Core/NamedPropertiesBenchmark.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/Time.hpp"
+#include <map>
+#include <type_traits>
+
+constexpr int BENCHMARKED_KEY_COUNTS[] = { 1, 4, 10 };
+constexpr int FORWARDED_COPIES = 4; // Posted to a queue, handed to a job, ...
+constexpr int MAX_BENCHMARK_ITERATIONS = 100'000'000;
+
+static volatile int s_namedPropertiesChecksumSink = 0; // Written once per run, so the checksummed work can't be optimized away
+
+// The previous NamedProperties: a heap allocated property per value, found by walking the map with a case insensitive compare
+class MapNamedPropertyBase {
+public:
+	virtual ~MapNamedPropertyBase() = default;
+	virtual MapNamedPropertyBase* GetClone() const = 0;
+	virtual bool IsType(std::type_info const& type) const = 0;
+};
+
+template<typename T_Value>
+class MapNamedProperty : public MapNamedPropertyBase {
+public:
+	T_Value m_data;
+
+	MapNamedPropertyBase* GetClone() const {
+		MapNamedProperty<T_Value>* clone = new MapNamedProperty<T_Value>();
+		clone->m_data = m_data;
+		return clone;
+	}
+	virtual bool IsType(std::type_info const& type) const override { return (typeid(m_data).hash_code() == type.hash_code()); }
+};
+
+class MapNamedProperties {
+public:
+	MapNamedProperties() = default;
+	MapNamedProperties(MapNamedProperties const& otherNamedProperties) {
+		for (auto it = otherNamedProperties.m_keyValuePairs.begin(); it != otherNamedProperties.m_keyValuePairs.end(); it++) {
+			m_keyValuePairs[it->first] = it->second->GetClone();
+		}
+	}
+	~MapNamedProperties() {
+		for (auto& [key, value] : m_keyValuePairs) {
+			delete value;
+		}
+	}
+
+	template<typename T_Value>
+	T_Value GetValue(std::string const& name, T_Value const& defaultValue) const {
+		for (auto it = m_keyValuePairs.begin(); it != m_keyValuePairs.end(); it++) {
+			if (!AreStringsEqualCaseInsensitive(name, it->first)) continue;
+			if (!it->second->IsType(typeid(defaultValue))) return defaultValue;
+			return reinterpret_cast<MapNamedProperty<T_Value> const*>(it->second)->m_data;
+		}
+		return defaultValue;
+	}
+
+	template<typename T_Value>
+	void SetValue(std::string const& name, T_Value const& value) {
+		for (auto it = m_keyValuePairs.begin(); it != m_keyValuePairs.end(); it++) {
+			if (!AreStringsEqualCaseInsensitive(name, it->first)) continue;
+			if (it->second->IsType(typeid(value))) {
+				reinterpret_cast<MapNamedProperty<T_Value>*>(it->second)->m_data = value;
+				return;
+			}
+			delete it->second;
+			m_keyValuePairs.erase(it);
+			break;
+		}
+
+		MapNamedProperty<T_Value>* newProperty = new MapNamedProperty<T_Value>();
+		newProperty->m_data = value;
+		m_keyValuePairs[name] = newProperty;
+	}
+
+	std::map<std::string, MapNamedPropertyBase*> m_keyValuePairs;
+};
+
+// Same mix for both: what input, physics and console events usually carry
+template<typename T_Properties>
+static void FillProperties(T_Properties& properties, std::vector<std::string> const& keys)
+{
+	for (int keyIndex = 0; keyIndex < keys.size(); keyIndex++) {
+		switch (keyIndex % 4) {
+		case 0: properties.SetValue(keys[keyIndex], keyIndex); break;
+		case 1: properties.SetValue(keys[keyIndex], (float)keyIndex * 0.5f); break;
+		case 2: properties.SetValue(keys[keyIndex], std::string("Value")); break;
+		default: properties.SetValue(keys[keyIndex], true); break;
+		}
+	}
+}
+
+template<typename T_Properties, typename T_Key>
+static int ReadProperties(T_Properties const& properties, std::vector<T_Key> const& keys)
+{
+	int checksum = 0;
+	for (int keyIndex = 0; keyIndex < keys.size(); keyIndex++) {
+		switch (keyIndex % 4) {
+		case 0: checksum += properties.GetValue(keys[keyIndex], 0); break;
+		case 1: checksum += (int)properties.GetValue(keys[keyIndex], 0.0f); break;
+		case 2: checksum += (int)properties.GetValue(keys[keyIndex], std::string()).size(); break;
+		default: checksum += properties.GetValue(keys[keyIndex], false) ? 1 : 0; break;
+		}
+	}
+	return checksum;
+}
+
+// Seconds for amountOfIterations of one scenario, checksum keeps the compiler from dropping the work
+template<typename T_Properties>
+static double MeasureScenario(std::string const& scenarioName, std::vector<std::string> const& keys, std::vector<std::string> const& missingKeys,
+	std::vector<NamedPropertyKey> const& hashedKeys, int amountOfIterations, int& out_checksum)
+{
+	T_Properties filledProperties;
+	FillProperties(filledProperties, keys);
+
+	double startTime = GetCurrentTimeSeconds();
+	if (scenarioName == "Build") {
+		for (int iteration = 0; iteration < amountOfIterations; iteration++) {
+			T_Properties properties;
+			FillProperties(properties, keys);
+			out_checksum += ReadProperties(properties, keys) & 1;
+		}
+	}
+	else if (scenarioName == "Lookup") {
+		for (int iteration = 0; iteration < amountOfIterations; iteration++) {
+			out_checksum += ReadProperties(filledProperties, keys);
+		}
+	}
+	else if (scenarioName == "Hashed") {
+		// Names hashed once up front, the map has no equivalent so it looks up by string
+		for (int iteration = 0; iteration < amountOfIterations; iteration++) {
+			if constexpr (std::is_same_v<T_Properties, NamedProperties>) out_checksum += ReadProperties(filledProperties, hashedKeys);
+			else out_checksum += ReadProperties(filledProperties, keys);
+		}
+	}
+	else if (scenarioName == "Miss") {
+		for (int iteration = 0; iteration < amountOfIterations; iteration++) {
+			out_checksum += ReadProperties(filledProperties, missingKeys);
+		}
+	}
+	else if (scenarioName == "Copy") {
+		for (int iteration = 0; iteration < amountOfIterations; iteration++) {
+			T_Properties copiedProperties(filledProperties);
+			out_checksum += copiedProperties.GetValue(keys[0], 0);
+		}
+	}
+	else if (scenarioName == "Forward") {
+		// Args passed along by value a few times and read at the end, with the last one changing a value on its copy
+		for (int iteration = 0; iteration < amountOfIterations; iteration++) {
+			for (int copyIndex = 0; copyIndex < FORWARDED_COPIES; copyIndex++) {
+				T_Properties forwardedProperties(filledProperties);
+				if (copyIndex == FORWARDED_COPIES - 1) {
+					forwardedProperties.SetValue(keys[0], iteration);
+				}
+				out_checksum += forwardedProperties.GetValue(keys[0], 0);
+			}
+		}
+	}
+	return GetCurrentTimeSeconds() - startTime;
+}
+
+double NamedPropertiesBenchmarkResult::GetMapNanosecondsPerIteration() const
+{
+	return (m_amountOfIterations > 0) ? (m_mapSeconds * 1'000'000'000.0) / (double)m_amountOfIterations : 0.0;
+}
+
+double NamedPropertiesBenchmarkResult::GetFlatNanosecondsPerIteration() const
+{
+	return (m_amountOfIterations > 0) ? (m_flatSeconds * 1'000'000'000.0) / (double)m_amountOfIterations : 0.0;
+}
+
+void RunNamedPropertiesBenchmark(NamedPropertiesBenchmarkResults& out_results, int amountOfIterations)
+{
+	char const* scenarioNames[] = { "Build", "Lookup", "Hashed", "Miss", "Copy", "Forward" };
+	int checksum = 0;
+
+	for (int keyCount : BENCHMARKED_KEY_COUNTS) {
+		std::vector<std::string> keys;
+		std::vector<std::string> missingKeys;
+		std::vector<NamedPropertyKey> hashedKeys;
+		for (int keyIndex = 0; keyIndex < keyCount; keyIndex++) {
+			keys.push_back(Stringf("EventValue%d", keyIndex));
+			missingKeys.push_back(Stringf("MissingValue%d", keyIndex));
+			hashedKeys.push_back(NamedPropertyKey(keys[keyIndex]));
+		}
+
+		for (char const* scenarioName : scenarioNames) {
+			NamedPropertiesBenchmarkResult result;
+			result.m_scenarioName = scenarioName;
+			result.m_amountOfKeys = keyCount;
+			result.m_amountOfIterations = amountOfIterations;
+			result.m_mapSeconds = MeasureScenario<MapNamedProperties>(scenarioName, keys, missingKeys, hashedKeys, amountOfIterations, checksum);
+			result.m_flatSeconds = MeasureScenario<NamedProperties>(scenarioName, keys, missingKeys, hashedKeys, amountOfIterations, checksum);
+			out_results.push_back(result);
+		}
+	}
+
+	s_namedPropertiesChecksumSink = checksum;
+}
+
+void GetNamedPropertiesBenchmarkReport(NamedPropertiesBenchmarkResults const& results, std::vector<std::string>& out_reportLines)
+{
+	for (int resultIndex = 0; resultIndex < results.size(); resultIndex++) {
+		NamedPropertiesBenchmarkResult const& result = results[resultIndex];
+		double mapNanoseconds = result.GetMapNanosecondsPerIteration();
+		double flatNanoseconds = result.GetFlatNanosecondsPerIteration();
+		double speedUp = (flatNanoseconds > 0.0) ? mapNanoseconds / flatNanoseconds : 0.0;
+		out_reportLines.push_back(Stringf("%-8s keys: %3d map: %9.1f ns flat: %9.1f ns %6.2fx",
+			result.m_scenarioName.c_str(), result.m_amountOfKeys, mapNanoseconds, flatNanoseconds, speedUp));
+	}
+}
+
+bool Command_NamedPropertiesBenchmark(EventArgs& args)
+{
+	std::string iterationsText = args.GetValue("iterations", "");
+	int amountOfIterations = ParseClampedInt(iterationsText, 100'000, 1, MAX_BENCHMARK_ITERATIONS);
+
+	NamedPropertiesBenchmarkResults results;
+	RunNamedPropertiesBenchmark(results, amountOfIterations);
+
+	std::vector<std::string> reportLines;
+	GetNamedPropertiesBenchmarkReport(results, reportLines);
+	AddDevConsoleReportLines(reportLines);
+
+	return true;
+}
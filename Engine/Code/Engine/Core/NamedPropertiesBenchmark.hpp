@@ -0,0 +1,23 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+#include <vector>
+
+// NamedProperties against the std::map implementation it replaced, for EventArgs sized sets of ints, floats, bools and strings
+struct NamedPropertiesBenchmarkResult {
+	std::string m_scenarioName;
+	int m_amountOfKeys = 0;
+	int m_amountOfIterations = 0;
+	double m_mapSeconds = 0.0;
+	double m_flatSeconds = 0.0;
+
+	double GetMapNanosecondsPerIteration() const;
+	double GetFlatNanosecondsPerIteration() const;
+};
+
+typedef std::vector<NamedPropertiesBenchmarkResult> NamedPropertiesBenchmarkResults;
+
+void RunNamedPropertiesBenchmark(NamedPropertiesBenchmarkResults& out_results, int amountOfIterations);
+void GetNamedPropertiesBenchmarkReport(NamedPropertiesBenchmarkResults const& results, std::vector<std::string>& out_reportLines);
+
+bool Command_NamedPropertiesBenchmark(EventArgs& args);
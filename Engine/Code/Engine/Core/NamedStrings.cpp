@@ -1,8 +1,5 @@
 #include "Engine/Core/NamedStrings.hpp"
-#include "Engine/Math/IntRange.hpp"
-#include "Engine/Math/FloatRange.hpp"
-#include "Engine/Math/AABB2.hpp"
-#include "Engine/Math/AABB3.hpp"
+#include <stdlib.h>
 
 NamedStrings::NamedStrings()
 {
@@ -12,6 +9,35 @@ NamedStrings::~NamedStrings()
 {
 }
 
+void NamedStringValue::SetFromText(std::string const& text)
+{
+	m_text = text;
+	m_parsedValue = std::monostate();
+
+	m_boolValue = AreStringsEqualCaseInsensitive(text, "true") || AreStringsEqualCaseInsensitive(text, "t") || (text == "1");
+
+	// Same results as stoi/stod on the leading number, without throwing on text that isn't one
+	char* numberEnd = nullptr;
+	m_doubleValue = strtod(text.c_str(), &numberEnd);
+	m_isNumber = (numberEnd != text.c_str());
+	m_floatValue = static_cast<float>(m_doubleValue);
+	m_intValue = static_cast<int>(strtol(text.c_str(), nullptr, 10));
+}
+
+template<typename T_Value>
+static T_Value GetParsedValue(NamedStringValue const* namedValue, T_Value const& defaultValue)
+{
+	if (!namedValue) return defaultValue;
+
+	T_Value const* parsedValue = std::get_if<T_Value>(&namedValue->m_parsedValue);
+	if (parsedValue) return *parsedValue;
+
+	T_Value value;
+	value.SetFromText(namedValue->m_text.c_str());
+	namedValue->m_parsedValue = value;
+	return value;
+}
+
 void NamedStrings::PopulateFromXmlElementAttributes(XMLElement const& element)
 {
 	tinyxml2::XMLAttribute const* attribute = element.FirstAttribute();
@@ -24,164 +50,92 @@ void NamedStrings::PopulateFromXmlElementAttributes(XMLElement const& element)
 
 void NamedStrings::SetValue(std::string const& keyName, std::string const& newValue)
 {
-	m_keyValuePairs[keyName] = newValue;
+	m_keyValuePairs[keyName].SetFromText(newValue);
+	m_revision++;
+}
+
+NamedStringValue const* NamedStrings::FindValue(std::string const& keyName) const
+{
+	auto iter = m_keyValuePairs.find(keyName);
+	if ((iter == m_keyValuePairs.end()) || iter->second.m_text.empty()) return nullptr;
+	return &iter->second;
 }
 
 std::string NamedStrings::GetValue(std::string const& keyName, std::string const& defaultValue) const
 {
-	for (std::map<std::string, std::string>::const_iterator iter = m_keyValuePairs.begin(); iter != m_keyValuePairs.end(); iter++) {
-		if (AreStringsEqualCaseInsensitive(keyName, iter->first)) {
-			return iter->second;
-		}
-	}
-	return defaultValue;
+	auto iter = m_keyValuePairs.find(keyName);
+	if (iter == m_keyValuePairs.end()) return defaultValue;
+	return iter->second.m_text;
 }
 
 bool NamedStrings::GetValue(std::string const& keyName, bool defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-
-	if (!valueAsString.empty()) {
-		bool isTrue = AreStringsEqualCaseInsensitive(valueAsString, "true");
-		isTrue = isTrue || AreStringsEqualCaseInsensitive(valueAsString, "t");
-		isTrue = isTrue || valueAsString == "1";
-
-		return isTrue;
-	}
-	
-	return defaultValue;
+	NamedStringValue const* value = FindValue(keyName);
+	return (value) ? value->m_boolValue : defaultValue;
 }
 
 int NamedStrings::GetValue(std::string const& keyName, int defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		return stoi(valueAsString);
-	}
-	return defaultValue;
+	NamedStringValue const* value = FindValue(keyName);
+	return (value && value->m_isNumber) ? value->m_intValue : defaultValue;
 }
 
 float NamedStrings::GetValue(std::string const& keyName, float defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		return std::stof(valueAsString);
-	}
-	return defaultValue;
+	NamedStringValue const* value = FindValue(keyName);
+	return (value && value->m_isNumber) ? value->m_floatValue : defaultValue;
 }
 
-
 double NamedStrings::GetValue(std::string const& keyName, double defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		return std::stod(valueAsString);
-	}
-	return defaultValue;
+	NamedStringValue const* value = FindValue(keyName);
+	return (value && value->m_isNumber) ? value->m_doubleValue : defaultValue;
 }
 
 std::string NamedStrings::GetValue(std::string const& keyName, char const* defaultValue) const
 {
-	for (std::map<std::string, std::string>::const_iterator iter = m_keyValuePairs.begin(); iter != m_keyValuePairs.end(); iter++) {
-		if (AreStringsEqualCaseInsensitive(keyName, iter->first)) {
-			return iter->second;
-		}
-	}
-	return defaultValue;
+	auto iter = m_keyValuePairs.find(keyName);
+	if (iter == m_keyValuePairs.end()) return defaultValue;
+	return iter->second.m_text;
 }
 
 Rgba8 NamedStrings::GetValue(std::string const& keyName, Rgba8 const& defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		Rgba8 value;
-		value.SetFromText(valueAsString.c_str());
-		return value;
-	}
-	return defaultValue;
+	return GetParsedValue(FindValue(keyName), defaultValue);
 }
 
 Vec2 NamedStrings::GetValue(std::string const& keyName, Vec2 const& defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		Vec2 value;
-		value.SetFromText(valueAsString.c_str());
-		return value;
-	}
-
-	return defaultValue;
+	return GetParsedValue(FindValue(keyName), defaultValue);
 }
 
 IntVec2 NamedStrings::GetValue(std::string const& keyName, IntVec2 const& defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		IntVec2 value;
-		value.SetFromText(valueAsString.c_str());
-		return value;
-	}
-
-	return defaultValue;
+	return GetParsedValue(FindValue(keyName), defaultValue);
 }
 
 IntVec3 NamedStrings::GetValue(std::string const& keyName, IntVec3 const& defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		IntVec3 value;
-		value.SetFromText(valueAsString.c_str());
-		return value;
-	}
-
-	return defaultValue;
+	return GetParsedValue(FindValue(keyName), defaultValue);
 }
 
 IntRange NamedStrings::GetValue(std::string const& keyName, IntRange const& defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		IntRange value;
-		value.SetFromText(valueAsString.c_str());
-		return value;
-	}
-
-	return defaultValue;
+	return GetParsedValue(FindValue(keyName), defaultValue);
 }
 
 FloatRange NamedStrings::GetValue(std::string const& keyName, FloatRange const& defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		FloatRange value;
-		value.SetFromText(valueAsString.c_str());
-		return value;
-	}
-
-	return defaultValue;
+	return GetParsedValue(FindValue(keyName), defaultValue);
 }
 
 AABB2 NamedStrings::GetValue(std::string const& keyName, AABB2 const& defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		AABB2 value;
-		value.SetFromText(valueAsString.c_str());
-		return value;
-	}
-
-	return defaultValue;
+	return GetParsedValue(FindValue(keyName), defaultValue);
 }
 
 AABB3 NamedStrings::GetValue(std::string const& keyName, AABB3 const& defaultValue) const
 {
-	std::string valueAsString = GetValue(keyName, std::string());
-	if (!valueAsString.empty()) {
-		AABB3 value;
-		value.SetFromText(valueAsString.c_str());
-		return value;
-	}
-
-	return defaultValue;
+	return GetParsedValue(FindValue(keyName), defaultValue);
 }
 
@@ -1,10 +1,28 @@
 #pragma once
-#include <map>
+#include <unordered_map>
 #include "Engine/Core/XmlUtils.hpp"
+#include "Engine/Math/IntRange.hpp"
+#include "Engine/Math/FloatRange.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/AABB3.hpp"
 #include <string>
+#include <variant>
+
+// The text as set, with the scalar conversions already done so bool/int/float/double reads never parse
+struct NamedStringValue {
+	std::string m_text;
+	bool m_boolValue = false;
+	int m_intValue = 0;
+	float m_floatValue = 0.0f;
+	double m_doubleValue = 0.0;
+	bool m_isNumber = false; // Text didn't start with a number, numeric reads return their default
+	// Compound values get parsed on their first typed read and kept until the text changes. Only the last type read is kept,
+	// a key read as two different compound types parses again whenever the type switches
+	mutable std::variant<std::monostate, Rgba8, Vec2, IntVec2, IntVec3, IntRange, FloatRange, AABB2, AABB3> m_parsedValue;
+
+	void SetFromText(std::string const& text);
+};
 
-struct AABB2;
-struct AABB3;
 class NamedStrings {
 public:
 	NamedStrings();
@@ -27,6 +45,43 @@ public:
 	AABB2 GetValue(std::string const& keyName, AABB2 const& defaultValue) const;
 	AABB3 GetValue(std::string const& keyName, AABB3 const& defaultValue) const;
 
+	unsigned int GetRevision() const { return m_revision; } // Changes with every SetValue, so handles know when to read again
+
+private:
+	NamedStringValue const* FindValue(std::string const& keyName) const; // nullptr if missing or empty, like before empty means unset
+
+private:
+	std::unordered_map<std::string, NamedStringValue, CaseInsensitiveStringHash, CaseInsensitiveStringEqual> m_keyValuePairs;
+	unsigned int m_revision = 0;
+};
+
+// A key read once and kept as a typed value, so code reading config every frame does no lookup nor parsing.
+// Reads again only after the NamedStrings changed. Same thread as the NamedStrings, like the rest of the blackboard
+//	NamedStringHandle<float> m_playerSpeed{ g_gameConfigBlackboard, "PLAYER_SPEED", 10.0f };
+//	float distance = m_playerSpeed * deltaSeconds;
+template<typename T_Value>
+class NamedStringHandle {
+public:
+	NamedStringHandle(NamedStrings const& namedStrings, std::string const& keyName, T_Value const& defaultValue) :
+		m_namedStrings(&namedStrings),
+		m_keyName(keyName),
+		m_defaultValue(defaultValue) {}
+
+	T_Value const& Get() const {
+		if (!m_hasValue || (m_cachedRevision != m_namedStrings->GetRevision())) {
+			m_value = m_namedStrings->GetValue(m_keyName, m_defaultValue);
+			m_cachedRevision = m_namedStrings->GetRevision();
+			m_hasValue = true;
+		}
+		return m_value;
+	}
+	operator T_Value const&() const { return Get(); }
+
 private:
-	std::map <std::string, std::string> m_keyValuePairs;
-};
\ No newline at end of file
+	NamedStrings const* m_namedStrings = nullptr;
+	std::string m_keyName;
+	T_Value m_defaultValue;
+	mutable T_Value m_value = T_Value();
+	mutable unsigned int m_cachedRevision = 0;
+	mutable bool m_hasValue = false;
+};
@@ -0,0 +1,93 @@
+#include "Engine/Core/ParallelAlgorithms.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+constexpr int STOLEN_RANGE_SPLIT_BUDGET = 2; // Extra halvings a range gets when another thread steals it
+
+struct ParallelForTask {
+	JobSystem* m_jobSystem = nullptr;
+	ParallelRangeFunction m_function = nullptr;
+	void* m_context = nullptr;
+	int m_grainSize = 1;
+	JobCounter m_counter;
+};
+
+static void ExecuteParallelForRange(ParallelForTask& task, int rangeBegin, int rangeEnd, int splitBudget);
+
+class ParallelForJob : public Job {
+public:
+	ParallelForJob(ParallelForTask& task, int rangeBegin, int rangeEnd, int splitBudget) :
+		Job(DEFAULT_JOB_ID),
+		m_task(task),
+		m_rangeBegin(rangeBegin),
+		m_rangeEnd(rangeEnd),
+		m_splitBudget(splitBudget) {}
+
+protected:
+	virtual void Execute() override {
+		int splitBudget = m_splitBudget;
+		// Only real steals count: ranges queued from outside the workers all get picked up from the shared queue by some worker
+		if (WasStolen()) {
+			splitBudget += STOLEN_RANGE_SPLIT_BUDGET; // Someone was idle enough to steal it, so there's demand for more pieces
+		}
+		ExecuteParallelForRange(m_task, m_rangeBegin, m_rangeEnd, splitBudget);
+	}
+	virtual void OnFinished() override {}
+
+private:
+	ParallelForTask& m_task;
+	int m_rangeBegin = 0;
+	int m_rangeEnd = 0;
+	int m_splitBudget = 0;
+};
+
+static void ExecuteParallelForRange(ParallelForTask& task, int rangeBegin, int rangeEnd, int splitBudget)
+{
+	// The upper half goes to the queue for other workers to steal, this thread keeps going with the lower half
+	while (((rangeEnd - rangeBegin) > task.m_grainSize) && (splitBudget > 0)) {
+		int rangeMiddle = rangeBegin + ((rangeEnd - rangeBegin) / 2);
+		splitBudget--;
+		task.m_jobSystem->QueueJob(task.m_jobSystem->CreatePooledJob<ParallelForJob>(task, rangeMiddle, rangeEnd, splitBudget), &task.m_counter);
+		rangeEnd = rangeMiddle;
+	}
+
+	task.m_function(task.m_context, rangeBegin, rangeEnd);
+}
+
+bool IsParallelExecutionAvailable()
+{
+	return g_theJobSystem && (g_theJobSystem->GetNumThreads() > 0);
+}
+
+int GetParallelConcurrency()
+{
+	if (!g_theJobSystem) return 1;
+	return g_theJobSystem->GetNumThreads() + 1;
+}
+
+void ParallelForRanges(int begin, int end, int grainSize, ParallelRangeFunction function, void* context)
+{
+	if (end <= begin) return;
+	if (grainSize < 1) grainSize = 1;
+
+	if (((end - begin) <= grainSize) || !IsParallelExecutionAvailable()) {
+		function(context, begin, end);
+		return;
+	}
+
+	ParallelForTask task;
+	task.m_jobSystem = g_theJobSystem;
+	task.m_function = function;
+	task.m_context = context;
+	task.m_grainSize = grainSize;
+
+	// Enough initial halvings for a few pieces per thread, stealing adds more where it's needed
+	int initialSplitBudget = 1;
+	while ((1 << initialSplitBudget) < GetParallelConcurrency() * 4) {
+		initialSplitBudget++;
+	}
+
+	ExecuteParallelForRange(task, begin, end, initialSplitBudget);
+
+	// Help with whatever is left instead of just waiting, the pieces still queued are most likely ours
+	task.m_jobSystem->HelpUntilCounterCompletion(task.m_counter);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Data parallel loops on top of g_theJobSystem. Ranges get split in halves while there's split budget left, and a half that
+// gets stolen by another worker earns more budget, so work only gets cut finer where threads are actually free to take it.
+// The calling thread always runs part of the range itself, and everything runs inline when there's no JobSystem to help.
+
+typedef void (*ParallelRangeFunction)(void* context, int rangeBegin, int rangeEnd);
+
+constexpr int PARALLEL_SORT_DEFAULT_GRAIN_SIZE = 2048;
+
+bool IsParallelExecutionAvailable();
+int GetParallelConcurrency(); // Workers + the calling thread
+void ParallelForRanges(int begin, int end, int grainSize, ParallelRangeFunction function, void* context);
+
+// function(int rangeBegin, int rangeEnd) over chunks of at least grainSize elements (except for the last one)
+template<typename T_RangeFunction>
+void ParallelForRange(int begin, int end, int grainSize, T_RangeFunction const& function)
+{
+	ParallelRangeFunction rangeFunction = [](void* context, int rangeBegin, int rangeEnd) {
+		T_RangeFunction const& userFunction = *static_cast<T_RangeFunction const*>(context);
+		userFunction(rangeBegin, rangeEnd);
+	};
+	ParallelForRanges(begin, end, grainSize, rangeFunction, (void*)&function);
+}
+
+// function(int index) for every index in [begin, end)
+template<typename T_Function>
+void ParallelFor(int begin, int end, int grainSize, T_Function const& function)
+{
+	ParallelRangeFunction rangeFunction = [](void* context, int rangeBegin, int rangeEnd) {
+		T_Function const& userFunction = *static_cast<T_Function const*>(context);
+		for (int index = rangeBegin; index < rangeEnd; index++) {
+			userFunction(index);
+		}
+	};
+	ParallelForRanges(begin, end, grainSize, rangeFunction, (void*)&function);
+}
+
+// reduceRange(int rangeBegin, int rangeEnd) -> T_Value, combine(T_Value, T_Value) -> T_Value has to be associative.
+// Partial results are combined in index order, so combine doesn't need to be commutative
+template<typename T_Value, typename T_RangeFunction, typename T_CombineFunction>
+T_Value ParallelReduce(int begin, int end, int grainSize, T_Value const& identity, T_RangeFunction const& reduceRange, T_CombineFunction const& combine)
+{
+	std::vector<std::pair<int, T_Value>> partialResults;
+	std::mutex partialResultsMutex;
+
+	ParallelForRange(begin, end, grainSize, [&](int rangeBegin, int rangeEnd) {
+		T_Value partialResult = reduceRange(rangeBegin, rangeEnd);
+		partialResultsMutex.lock();
+		partialResults.emplace_back(rangeBegin, partialResult);
+		partialResultsMutex.unlock();
+	});
+
+	std::sort(partialResults.begin(), partialResults.end(), [](std::pair<int, T_Value> const& first, std::pair<int, T_Value> const& second) {
+		return first.first < second.first;
+	});
+
+	T_Value result = identity;
+	for (int partialIndex = 0; partialIndex < partialResults.size(); partialIndex++) {
+		result = combine(result, partialResults[partialIndex].second);
+	}
+	return result;
+}
+
+// output[i] = transform(input[i]) for random access iterators. Output can alias input
+template<typename T_InputIterator, typename T_OutputIterator, typename T_Function>
+void ParallelTransform(T_InputIterator first, T_InputIterator last, T_OutputIterator output, int grainSize, T_Function const& transform)
+{
+	int amountOfElements = static_cast<int>(last - first);
+	ParallelFor(0, amountOfElements, grainSize, [&](int index) {
+		output[index] = transform(first[index]);
+	});
+}
+
+// Chunks get sorted in parallel, then merged pairwise in parallel passes
+template<typename T_Iterator, typename T_Compare>
+void ParallelSort(T_Iterator first, T_Iterator last, T_Compare const& compare, int grainSize = PARALLEL_SORT_DEFAULT_GRAIN_SIZE)
+{
+	int amountOfElements = static_cast<int>(last - first);
+	if (grainSize < 1) grainSize = 1;
+	if ((amountOfElements <= grainSize) || !IsParallelExecutionAvailable()) {
+		std::sort(first, last, compare);
+		return;
+	}
+
+	int amountOfChunks = (amountOfElements + grainSize - 1) / grainSize;
+	int maxAmountOfChunks = GetParallelConcurrency() * 4;
+	if (amountOfChunks > maxAmountOfChunks) amountOfChunks = maxAmountOfChunks;
+	int chunkSize = (amountOfElements + amountOfChunks - 1) / amountOfChunks;
+
+	ParallelFor(0, amountOfChunks, 1, [&](int chunkIndex) {
+		int chunkBegin = chunkIndex * chunkSize;
+		int chunkEnd = (chunkBegin + chunkSize < amountOfElements) ? chunkBegin + chunkSize : amountOfElements;
+		if (chunkBegin < chunkEnd) {
+			std::sort(first + chunkBegin, first + chunkEnd, compare);
+		}
+	});
+
+	for (int sortedWidth = chunkSize; sortedWidth < amountOfElements; sortedWidth *= 2) {
+		int amountOfMerges = (amountOfElements + (sortedWidth * 2) - 1) / (sortedWidth * 2);
+		ParallelFor(0, amountOfMerges, 1, [&](int mergeIndex) {
+			int mergeBegin = mergeIndex * sortedWidth * 2;
+			int mergeMiddle = (mergeBegin + sortedWidth < amountOfElements) ? mergeBegin + sortedWidth : amountOfElements;
+			int mergeEnd = (mergeMiddle + sortedWidth < amountOfElements) ? mergeMiddle + sortedWidth : amountOfElements;
+			if (mergeMiddle < mergeEnd) {
+				std::inplace_merge(first + mergeBegin, first + mergeMiddle, first + mergeEnd, compare);
+			}
+		});
+	}
+}
+
+template<typename T_Iterator>
+void ParallelSort(T_Iterator first, T_Iterator last, int grainSize = PARALLEL_SORT_DEFAULT_GRAIN_SIZE)
+{
+	ParallelSort(first, last, std::less<>(), grainSize);
+}
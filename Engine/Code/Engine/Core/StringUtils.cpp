@@ -2,6 +2,7 @@
 #include <stdarg.h>
 #include <locale>
 #include <algorithm>
+#include <stdlib.h>
 
 
 //-----------------------------------------------------------------------------------------------
@@ -101,6 +102,54 @@ bool AreStringsEqualCaseInsensitive(std::string const& stringA, std::string cons
 	return !_stricmp(stringA.c_str(), stringB.c_str());
 }
 
+size_t GetCaseInsensitiveHash(std::string const& text)
+{
+	// FNV-1a over the lowercase characters. Folding ASCII by hand, tolower goes through the locale for every character
+	// Offset and prime have to match the width of size_t, Win32 builds get the 32 bit ones
+	constexpr size_t FNV_OFFSET_BASIS = (sizeof(size_t) == 8) ? size_t(14695981039346656037ull) : size_t(2166136261u);
+	constexpr size_t FNV_PRIME = (sizeof(size_t) == 8) ? size_t(1099511628211ull) : size_t(16777619u);
+
+	size_t hash = FNV_OFFSET_BASIS;
+	for (int charIndex = 0; charIndex < text.size(); charIndex++) {
+		unsigned char character = static_cast<unsigned char>(text[charIndex]);
+		if ((character >= 'A') && (character <= 'Z')) character += 'a' - 'A';
+		hash ^= static_cast<size_t>(character);
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+int ParseClampedInt(std::string const& text, int defaultValue, int minValue, int maxValue)
+{
+	// For typed input like console args: stoi would throw on a typo
+	char const* textStart = text.c_str();
+	char* numberEnd = nullptr;
+	long value = strtol(textStart, &numberEnd, 10);
+	if ((numberEnd == textStart) || (*numberEnd != '\0')) return defaultValue;
+
+	if (value < minValue) return minValue;
+	if (value > maxValue) return maxValue;
+	return static_cast<int>(value);
+}
+
+void AppendJsonString(std::string& out_json, char const* text)
+{
+	out_json += '"';
+	for (char const* character = text; character && *character; character++) {
+		if ((*character == '"') || (*character == '\\')) {
+			out_json += '\\';
+			out_json += *character;
+		}
+		else if ((unsigned char)*character < 0x20) {
+			out_json += ' ';
+		}
+		else {
+			out_json += *character;
+		}
+	}
+	out_json += '"';
+}
+
 bool IsStringAllWhitespace(std::string const& str)
 {
 	for (int index = 0; index < str.size(); index++) {
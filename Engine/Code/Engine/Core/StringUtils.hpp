@@ -14,8 +14,20 @@ Strings SplitStringOnSpace(const std::string& originalString);
 void RemoveEmptyStrings(Strings& originalStrings);
 
 bool AreStringsEqualCaseInsensitive(std::string const& stringA, std::string const& stringB);
+size_t GetCaseInsensitiveHash(std::string const& text); // Same hash for every capitalization
 bool IsStringAllWhitespace(std::string const& str);
+int ParseClampedInt(std::string const& text, int defaultValue, int minValue, int maxValue); // defaultValue unless the whole text is a number
+void AppendJsonString(std::string& out_json, char const* text); // Quoted and escaped, control characters become spaces
 inline void TrimString(std::string& str);
 std::string TrimStringCopy(std::string const& str);
 bool ContainsString(std::string const& baseStr, std::string const& otherString);
-bool ContainsStringCaseInsensitive(std::string const& baseStr, std::string const& otherString);
\ No newline at end of file
+bool ContainsStringCaseInsensitive(std::string const& baseStr, std::string const& otherString);
+
+// For unordered containers keyed by names that ignore the case
+struct CaseInsensitiveStringHash {
+	size_t operator()(std::string const& text) const { return GetCaseInsensitiveHash(text); }
+};
+
+struct CaseInsensitiveStringEqual {
+	bool operator()(std::string const& stringA, std::string const& stringB) const { return (stringA.size() == stringB.size()) && AreStringsEqualCaseInsensitive(stringA, stringB); }
+};
@@ -1,4 +1,5 @@
 #include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Core/ParallelAlgorithms.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/OBB2.hpp"
 #include "Engine/Math/LineSegment2.hpp"
@@ -8,6 +9,8 @@
 #include "Engine/Math/ConvexHull2D.hpp"
 #include "Engine/Math/ConvexPoly2D.hpp"
 
+constexpr int TRANSFORM_VERTS_GRAIN_SIZE = 8192;
+
 void TransformVertexArrayXY3D(int numVerts, Vertex_PCU* verts, float uniformScaleXY, float rotationDegreesAboutZ, Vec2 const& translationXY)
 {
 	for (int vertIndex = 0; vertIndex < numVerts; vertIndex++) {
@@ -430,10 +433,13 @@ void AddVertsForConvexHull2D(std::vector<Vertex_PCU>& verts, ConvexHull2D const&
 
 void TransformVertexArray3D(int numVerts, Vertex_PCU* verts, Mat44 const& model)
 {
-	for (int vertIndex = 0; vertIndex < numVerts; vertIndex++) {
-		Vertex_PCU& vertex = verts[vertIndex];
-		TransformPosition3D(vertex.m_position, model);
-	}
+	// Small arrays (most billboards) stay on the calling thread, ParallelForRange only splits past the grain size
+	ParallelForRange(0, numVerts, TRANSFORM_VERTS_GRAIN_SIZE, [verts, &model](int rangeBegin, int rangeEnd) {
+		for (int vertIndex = rangeBegin; vertIndex < rangeEnd; vertIndex++) {
+			Vertex_PCU& vertex = verts[vertIndex];
+			TransformPosition3D(vertex.m_position, model);
+		}
+	});
 }
 
 void AddVertsForLineSegment3D(std::vector<Vertex_PCU>& verts, Vec3 const& start, Vec3 const& end, Rgba8 const& color, float thickness)
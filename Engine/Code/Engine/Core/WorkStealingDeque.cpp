@@ -0,0 +1,113 @@
+#include "Engine/Core/WorkStealingDeque.hpp"
+
+WorkStealingDeque::RingBuffer::RingBuffer(int64_t capacity) :
+	m_capacity(capacity),
+	m_mask(capacity - 1)
+{
+	m_slots = new std::atomic<Job*>[capacity];
+}
+
+WorkStealingDeque::RingBuffer::~RingBuffer()
+{
+	delete[] m_slots;
+	m_slots = nullptr;
+}
+
+WorkStealingDeque::RingBuffer* WorkStealingDeque::RingBuffer::Grow(int64_t bottom, int64_t top) const
+{
+	RingBuffer* newBuffer = new RingBuffer(m_capacity * 2);
+	for (int64_t index = top; index < bottom; index++) {
+		newBuffer->Put(index, Get(index));
+	}
+	return newBuffer;
+}
+
+WorkStealingDeque::WorkStealingDeque(int64_t initialCapacity)
+{
+	int64_t capacity = 2;
+	while (capacity < initialCapacity) { // Capacity has to be a power of 2 for the index mask
+		capacity <<= 1;
+	}
+	m_buffer.store(new RingBuffer(capacity), std::memory_order_relaxed);
+}
+
+WorkStealingDeque::~WorkStealingDeque()
+{
+	delete m_buffer.load(std::memory_order_relaxed);
+	for (int bufferIndex = 0; bufferIndex < m_retiredBuffers.size(); bufferIndex++) {
+		delete m_retiredBuffers[bufferIndex];
+	}
+	m_retiredBuffers.clear();
+}
+
+void WorkStealingDeque::Push(Job* job)
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_acquire);
+	RingBuffer* buffer = m_buffer.load(std::memory_order_relaxed);
+
+	if ((bottom - top) > (buffer->m_capacity - 1)) {
+		RingBuffer* grownBuffer = buffer->Grow(bottom, top);
+		m_retiredBuffers.push_back(buffer);
+		buffer = grownBuffer;
+		m_buffer.store(buffer, std::memory_order_release);
+	}
+
+	buffer->Put(bottom, job);
+	m_bottom.store(bottom + 1, std::memory_order_release); // Publishes the job (and everything written to it) to thieves
+}
+
+Job* WorkStealingDeque::Pop()
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	RingBuffer* buffer = m_buffer.load(std::memory_order_relaxed);
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	Job* job = nullptr;
+	if (top <= bottom) {
+		job = buffer->Get(bottom);
+		if (top == bottom) { // Last job, race against thieves for it
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+	}
+	else {
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+Job* WorkStealingDeque::Steal()
+{
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+	Job* job = nullptr;
+	if (top < bottom) {
+		RingBuffer* buffer = m_buffer.load(std::memory_order_acquire);
+		job = buffer->Get(top);
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr; // Lost the race against the owner or another thief
+		}
+	}
+
+	return job;
+}
+
+bool WorkStealingDeque::IsEmpty() const
+{
+	return GetSize() <= 0;
+}
+
+int64_t WorkStealingDeque::GetSize() const
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+	return bottom - top;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class Job;
+
+// Keeping top, bottom and buffer on their own cache lines pads the class, which is the point
+#pragma warning(push)
+#pragma warning(disable : 4324) // Structure was padded due to alignment specifier
+
+// Chase-Lev work-stealing deque (Le et al. 2013 memory ordering)
+// Push/Pop may only be called from the owning thread, Steal may be called from any thread
+class WorkStealingDeque {
+public:
+	WorkStealingDeque(int64_t initialCapacity = 256);
+	~WorkStealingDeque();
+	WorkStealingDeque(WorkStealingDeque const& copy) = delete;
+
+	void Push(Job* job);
+	Job* Pop();
+	Job* Steal();
+
+	bool IsEmpty() const;
+	int64_t GetSize() const;
+
+private:
+	struct RingBuffer {
+		RingBuffer(int64_t capacity);
+		~RingBuffer();
+
+		Job* Get(int64_t index) const { return m_slots[index & m_mask].load(std::memory_order_relaxed); }
+		void Put(int64_t index, Job* job) { m_slots[index & m_mask].store(job, std::memory_order_relaxed); }
+		RingBuffer* Grow(int64_t bottom, int64_t top) const;
+
+		int64_t m_capacity = 0;
+		int64_t m_mask = 0;
+		std::atomic<Job*>* m_slots = nullptr;
+	};
+
+private:
+	alignas(64) std::atomic<int64_t> m_top = 0;
+	alignas(64) std::atomic<int64_t> m_bottom = 0;
+	alignas(64) std::atomic<RingBuffer*> m_buffer = nullptr;
+	std::vector<RingBuffer*> m_retiredBuffers; // Thieves may still be reading old buffers, so they live until the deque dies
+};
+
+#pragma warning(pop)
@@ -48,6 +48,9 @@ void InputSystem::Startup()
 		m_xboxControllers[xboxControllerIndex].m_id = xboxControllerIndex;
 	}
 
+	m_keyPressedEventId = RegisterEvent("HandleKeyPressedDev");
+	m_keyReleasedEventId = RegisterEvent("HandleKeyReleasedDev");
+	m_charInputEventId = RegisterEvent("HandleCharInputDev");
 }
 
 void InputSystem::BeginFrame()
@@ -126,7 +129,7 @@ bool InputSystem::HandleKeyPressed(unsigned short keyCode)
 
 	EventArgs eventArgs;
 	eventArgs.SetValue("inputChar", keyCode);
-	FireEvent("HandleKeyPressedDev", eventArgs);
+	FireEvent(m_keyPressedEventId, eventArgs);
 
 	return true;
 }
@@ -137,7 +140,7 @@ void InputSystem::HandleKeyReleased(unsigned short keyCode)
 
 	EventArgs eventArgs;
 	eventArgs.SetValue("inputChar", keyCode);
-	FireEvent("HandleKeyReleasedDev", eventArgs);
+	FireEvent(m_keyReleasedEventId, eventArgs);
 }
 
 void InputSystem::ShutDown()
@@ -327,7 +330,7 @@ bool InputSystem::HandleCharInput(int charCode)
 {
 	EventArgs eventArgs;
 	eventArgs.SetValue("inputChar", charCode);
-	FireEvent("HandleCharInputDev", eventArgs);
+	FireEvent(m_charInputEventId, eventArgs);
 
 	if (charCode == 22) {
 		m_pasteCommand = true;
@@ -1,5 +1,6 @@
 #pragma once
 #include "Engine/Input/XboxController.hpp"
+#include "Engine/Core/EventSystem.hpp"
 
 extern unsigned char const KEYCODE_F2;
 extern unsigned char const KEYCODE_F1;
@@ -98,4 +99,9 @@ protected:
 	MouseState m_mouseState = {false, false, false};
 
 	bool m_pasteCommand = false;
+
+	// Fired on every key and character, registered once in Startup so they skip the name lookup
+	EventId m_keyPressedEventId;
+	EventId m_keyReleasedEventId;
+	EventId m_charInputEventId;
 };
\ No newline at end of file
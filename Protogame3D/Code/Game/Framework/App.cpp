@@ -8,6 +8,7 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/AsyncFileIO.hpp"
 
 #include <thread>
 
@@ -59,8 +60,20 @@ void App::Startup()
 	g_gameConfigBlackboard.SetValue("TEXT_CELL_HEIGHT_ATTRACT_SCREEN", std::to_string(TEXT_CELL_HEIGHT_ATTRACT_SCREEN));
 
 	EventSystemConfig eventSystemConfig;
+	eventSystemConfig.m_enableProfiling = g_gameConfigBlackboard.GetValue("EVENT_SYSTEM_PROFILING", false);
 	g_theEventSystem = new EventSystem(eventSystemConfig);
 
+	// The main thread takes part in parallel loops, so it counts as one of the cores
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_amountOfThreads = (int)std::thread::hardware_concurrency() - 1;
+	if (jobSystemConfig.m_amountOfThreads < 0) jobSystemConfig.m_amountOfThreads = 0;
+	jobSystemConfig.m_enableProfiling = g_gameConfigBlackboard.GetValue("JOB_SYSTEM_PROFILING", false);
+	g_theJobSystem = new JobSystem(jobSystemConfig);
+
+	AsyncFileIOConfig asyncFileIOConfig;
+	asyncFileIOConfig.m_jobSystem = g_theJobSystem;
+	g_theAsyncFileIO = new AsyncFileIO(asyncFileIOConfig);
+
 	NetworkSystemConfig networkSysConfig;
 	g_theNetwork = new NetworkSystem(networkSysConfig);
 
@@ -91,6 +104,8 @@ void App::Startup()
 	g_theGame = new Game(this);
 
 	g_theEventSystem->Startup();
+	g_theJobSystem->Startup();
+	g_theAsyncFileIO->Startup();
 	g_theNetwork->Startup();
 	g_theInput->Startup();
 	g_theWindow->Startup();
@@ -116,6 +131,7 @@ void App::BeginFrame()
 {
 	Clock::SystemBeginFrame();
 	g_theEventSystem->BeginFrame();
+	g_theJobSystem->BeginFrame();
 	g_theNetwork->BeginFrame();
 	g_theConsole->BeginFrame();
 	g_theInput->BeginFrame();
@@ -134,6 +150,7 @@ void App::Render() const
 void App::EndFrame()
 {
 	g_theEventSystem->EndFrame();
+	g_theJobSystem->EndFrame();
 	g_theNetwork->EndFrame();
 	g_theConsole->EndFrame();
 	g_theInput->EndFrame();
@@ -200,6 +217,14 @@ void App::Shutdown()
 	delete g_theNetwork;
 	g_theNetwork = nullptr;
 
+	g_theAsyncFileIO->Shutdown();
+	delete g_theAsyncFileIO;
+	g_theAsyncFileIO = nullptr;
+
+	g_theJobSystem->Shutdown();
+	delete g_theJobSystem;
+	g_theJobSystem = nullptr;
+
 	g_theEventSystem->Shutdown();
 	delete g_theEventSystem;
 	g_theEventSystem = nullptr;
@@ -1,9 +1,12 @@
 #include "Engine/Renderer/Renderer.hpp"
 #include "Engine/Renderer/DebugRendererSystem.hpp"
 #include "Engine/Renderer/Interfaces/Buffer.hpp"
+#include "Engine/Core/ParallelAlgorithms.hpp"
 #include "Game/Gameplay/GameMode.hpp"
 #include "Game/Framework/GameCommon.hpp"
 
+constexpr int ENTITY_UPDATE_GRAIN_SIZE = 64;
+
 GameMode::~GameMode()
 {
 
@@ -243,10 +246,16 @@ void GameMode::UpdateCamera(Camera const& camera, Buffer* cBuffer)
 
 void GameMode::UpdateEntities(float deltaSeconds)
 {
-	for (int entityIndex = 0; entityIndex < m_allEntities.size(); entityIndex++) {
+	// The player reads input and drives the camera, so it stays on the main thread. Everything else only touches itself
+	if (m_player) {
+		m_player->Update(deltaSeconds);
+	}
+
+	ParallelFor(0, (int)m_allEntities.size(), ENTITY_UPDATE_GRAIN_SIZE, [this, deltaSeconds](int entityIndex) {
 		Entity* entity = m_allEntities[entityIndex];
+		if (entity == m_player) return;
 		entity->Update(deltaSeconds);
-	}
+	});
 }
 
 void GameMode::RenderEntities() const